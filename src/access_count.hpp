@@ -0,0 +1,166 @@
+/*Copyright or © or Copr. CNRS (2019). Contributors:
+- Vincent Lanore. vincent.lanore@gmail.com
+
+This software is a computer program whose purpose is to provide header-only library to create tuple
+indexed by type tags.
+
+This software is governed by the CeCILL-C license under French law and abiding by the rules of
+distribution of free software. You can use, modify and/ or redistribute the software under the terms
+of the CeCILL-C license as circulated by CEA, CNRS and INRIA at the following URL
+"http://www.cecill.info".
+
+As a counterpart to the access to the source code and rights to copy, modify and redistribute
+granted by the license, users are provided only with a limited warranty and the software's author,
+the holder of the economic rights, and the successive licensors have only limited liability.
+
+In this respect, the user's attention is drawn to the risks associated with loading, using,
+modifying and/or developing or reproducing the software by the user in light of its specific status
+of free software, that may mean that it is complicated to manipulate, and that also therefore means
+that it is reserved for developers and experienced professionals having in-depth computer knowledge.
+Users are therefore encouraged to load and test the software's suitability as regards their
+requirements in conditions enabling the security of their systems and/or data to be ensured and,
+more generally, to use and operate it in the same conditions as regards security.
+
+The fact that you are presently reading this means that you have had knowledge of the CeCILL-C
+license and that you accept its terms.*/
+
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <vector>
+#include "tag_name.hpp"
+
+/* Per-(tuple type, tag) counts of get<Key> calls, to find hot fields. Counting is enabled per tuple
+type with the count_accesses metadata tag, e.g. metadata<type_list<count_accesses>, type_map<>>,
+or for every tuple by defining TAGGED_TUPLE_COUNT_ACCESSES before including any header (the
+definition must then be the same in all translation units). When disabled, get<Key> contains no
+counting code.
+
+Each thread increments its own counter without atomic read-modify-write; counters of all threads
+are linked in lock-free lists and summed by access_report(). A counter is released when its thread
+exits and reused, count included, by the next thread that needs one, so the lists grow with the
+number of concurrent threads, not with the number of threads ever started. */
+
+struct count_accesses {};
+
+//==================================================================================================
+namespace helper {
+    struct access_counter_node {
+        std::atomic<uint64_t> count{0};
+        std::atomic<bool> in_use{true};
+        access_counter_node* next{nullptr};
+    };
+
+    struct access_counter {
+        const_string tuple_name, tag_name;
+        std::atomic<access_counter_node*> nodes{nullptr};  // one per thread
+        access_counter* next{nullptr};
+
+        access_counter(const_string tuple_name, const_string tag_name);
+
+        // node of the calling thread: a released one if any, else a new one (nodes are never
+        // freed so counts survive thread exit)
+        access_counter_node* acquire_node() {
+            auto node = nodes.load(std::memory_order_acquire);
+            for (; node != nullptr; node = node->next) {
+                if (not node->in_use.load(std::memory_order_relaxed) and
+                    not node->in_use.exchange(true, std::memory_order_acquire)) {
+                    return node;
+                }
+            }
+            node = new access_counter_node;
+            node->next = nodes.load(std::memory_order_relaxed);
+            while (not nodes.compare_exchange_weak(node->next, node, std::memory_order_release,
+                                                   std::memory_order_relaxed)) {
+            }
+            return node;
+        }
+    };
+
+    inline std::atomic<access_counter*>& access_counters() {
+        static std::atomic<access_counter*> head{nullptr};
+        return head;
+    }
+
+    inline access_counter::access_counter(const_string tuple_name, const_string tag_name)
+        : tuple_name(tuple_name), tag_name(tag_name) {
+        auto& head = access_counters();
+        next = head.load(std::memory_order_relaxed);
+        while (not head.compare_exchange_weak(next, this, std::memory_order_release,
+                                              std::memory_order_relaxed)) {
+        }
+    }
+
+    template <class TTuple, class Key>
+    access_counter& access_counter_of() {
+        static access_counter counter(type_name<TTuple>(), tag_name<Key>());
+        return counter;
+    }
+
+    // releases the node of its thread on thread exit
+    struct access_counter_slot {
+        access_counter_node* node;
+
+        explicit access_counter_slot(access_counter& counter) : node(counter.acquire_node()) {}
+        access_counter_slot(const access_counter_slot&) = delete;
+        access_counter_slot& operator=(const access_counter_slot&) = delete;
+        ~access_counter_slot() { node->in_use.store(false, std::memory_order_release); }
+    };
+
+    template <class TTuple, class Key>
+    void count_access_impl(access_count_tag) {
+        static thread_local access_counter_slot slot(access_counter_of<TTuple, Key>());
+        auto node = slot.node;
+        node->count.store(node->count.load(std::memory_order_relaxed) + 1,
+                          std::memory_order_relaxed);
+    }
+}  // namespace helper
+
+//==================================================================================================
+struct access_count {
+    const_string tuple_name, tag_name;
+    uint64_t count;
+};
+
+// accesses since program start (or last reset) for every counted (tuple type, tag), most accessed
+// first
+inline std::vector<access_count> access_report() {
+    std::vector<access_count> result;
+    auto counter = helper::access_counters().load(std::memory_order_acquire);
+    for (; counter != nullptr; counter = counter->next) {
+        uint64_t count = 0;
+        auto node = counter->nodes.load(std::memory_order_acquire);
+        for (; node != nullptr; node = node->next) {
+            count += node->count.load(std::memory_order_relaxed);
+        }
+        result.push_back({counter->tuple_name, counter->tag_name, count});
+    }
+    std::stable_sort(result.begin(), result.end(),
+                     [](const access_count& a, const access_count& b) {
+                         return a.count > b.count;
+                     });
+    return result;
+}
+
+// counts of a given (tuple type, tag)
+template <class TTuple, class Key>
+uint64_t access_count_of() {
+    uint64_t count = 0;
+    auto node = helper::access_counter_of<TTuple, Key>().nodes.load(std::memory_order_acquire);
+    for (; node != nullptr; node = node->next) {
+        count += node->count.load(std::memory_order_relaxed);
+    }
+    return count;
+}
+
+// not synchronized with concurrent accesses: increments racing with the reset may be lost
+inline void reset_access_counts() {
+    auto counter = helper::access_counters().load(std::memory_order_acquire);
+    for (; counter != nullptr; counter = counter->next) {
+        auto node = counter->nodes.load(std::memory_order_acquire);
+        for (; node != nullptr; node = node->next) {
+            node->count.store(0, std::memory_order_relaxed);
+        }
+    }
+}
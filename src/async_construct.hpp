@@ -0,0 +1,181 @@
+/*Copyright or © or Copr. CNRS (2019). Contributors:
+- Vincent Lanore. vincent.lanore@gmail.com
+
+This software is a computer program whose purpose is to provide header-only library to create tuple
+indexed by type tags.
+
+This software is governed by the CeCILL-C license under French law and abiding by the rules of
+distribution of free software. You can use, modify and/ or redistribute the software under the terms
+of the CeCILL-C license as circulated by CEA, CNRS and INRIA at the following URL
+"http://www.cecill.info".
+
+As a counterpart to the access to the source code and rights to copy, modify and redistribute
+granted by the license, users are provided only with a limited warranty and the software's author,
+the holder of the economic rights, and the successive licensors have only limited liability.
+
+In this respect, the user's attention is drawn to the risks associated with loading, using,
+modifying and/or developing or reproducing the software by the user in light of its specific status
+of free software, that may mean that it is complicated to manipulate, and that also therefore means
+that it is reserved for developers and experienced professionals having in-depth computer knowledge.
+Users are therefore encouraged to load and test the software's suitability as regards their
+requirements in conditions enabling the security of their systems and/or data to be ensured and,
+more generally, to use and operate it in the same conditions as regards security.
+
+The fact that you are presently reading this means that you have had knowledge of the CeCILL-C
+license and that you accept its terms.*/
+
+#pragma once
+
+#include <atomic>
+#include <exception>
+#include <future>
+#include <memory>
+#include <thread>
+#include "tagged_tuple.hpp"
+
+/* make_tagged_tuple_async(executor, deferred_field<A>(factory), value_field<B>(x), ...) builds
+the fields given by deferred_field concurrently, each by calling its factory in a task submitted
+to the executor, and returns a std::future of the tuple. The tuple is assembled by the task that
+finishes last, so no thread waits for the others. An executor is any callable taking a nullary
+task, e.g. thread_executor (one thread per task) or a wrapper around an existing thread pool.
+If a factory throws, the future holds the first exception thrown instead of a tuple. */
+
+//==================================================================================================
+// to be used in make_tagged_tuple_async calls; the field value is factory()
+template <class Tag, class F>
+struct DeferredField {
+    using value_type = std::decay_t<decltype(std::declval<F&>()())>;
+    using field_type = type_pair<Tag, value_type>;
+    F factory;
+};
+
+template <class Tag, class F>
+auto deferred_field(F&& factory) {
+    return DeferredField<Tag, std::decay_t<F>>{std::forward<F>(factory)};
+}
+
+// runs each task on its own detached thread
+struct thread_executor {
+    template <class Task>
+    void operator()(Task task) const {
+        std::thread(std::move(task)).detach();
+    }
+};
+
+// runs each task immediately in the calling thread
+struct inline_executor {
+    template <class Task>
+    void operator()(Task task) const {
+        task();
+    }
+};
+
+//==================================================================================================
+namespace helper {
+    // argument of make_tagged_tuple_async: ready value (TagValuePair) or deferred value
+    template <class Arg>
+    struct async_slot {
+        static constexpr bool deferred = false;
+        Arg pair;
+        explicit async_slot(Arg&& pair) : pair(std::move(pair)) {}
+        decltype(auto) move() { return pair.move(); }  // reference, or unique_ptr_init by value
+        void build() {}
+    };
+
+    template <class Tag, class F>
+    struct async_slot<DeferredField<Tag, F>> {
+        static constexpr bool deferred = true;
+        using value_type = typename DeferredField<Tag, F>::value_type;
+        F factory;
+        std::unique_ptr<value_type> value;
+        explicit async_slot(DeferredField<Tag, F>&& field) : factory(std::move(field.factory)) {}
+        value_type&& move() { return std::move(*value); }
+        void build() { value = std::make_unique<value_type>(factory()); }
+    };
+
+    template <class MD, class... Args>
+    class async_construction {
+        using result_t = tagged_tuple<MD, typename Args::field_type...>;
+        using indices = std::index_sequence_for<Args...>;
+
+        std::tuple<async_slot<Args>...> slots;
+        std::atomic<size_t> remaining;
+        std::promise<result_t> promise;
+        std::atomic_flag failed = ATOMIC_FLAG_INIT;
+        std::exception_ptr error;  // set once, by the first task whose factory throws
+
+        template <size_t... Is>
+        result_t assemble(std::index_sequence<Is...>) {
+            return result_t(tuple_construct(), std::get<Is>(slots).move()...);
+        }
+
+        void fail(std::exception_ptr e) {
+            if (not failed.test_and_set(std::memory_order_relaxed)) { error = e; }
+        }
+
+        // the last call sees all built slots and the error, if any (acquire-release on remaining)
+        void finish() {
+            if (remaining.fetch_sub(1, std::memory_order_acq_rel) == 1) {
+                if (error != nullptr) {
+                    promise.set_exception(error);
+                    return;
+                }
+                try {
+                    promise.set_value(assemble(indices()));
+                } catch (...) {
+                    promise.set_exception(std::current_exception());
+                }
+            }
+        }
+
+        template <size_t I, class Executor>
+        static void submit(const std::shared_ptr<async_construction>& state, Executor& executor,
+                           std::true_type /* deferred */) {
+            executor([state]() {
+                try {
+                    std::get<I>(state->slots).build();
+                } catch (...) {
+                    state->fail(std::current_exception());
+                }
+                state->finish();
+            });
+        }
+
+        template <size_t I, class Executor>
+        static void submit(const std::shared_ptr<async_construction>&, Executor&,
+                           std::false_type /* deferred */) {}
+
+        template <class Executor, size_t... Is>
+        static void start(const std::shared_ptr<async_construction>& state, Executor& executor,
+                          std::index_sequence<Is...>) {
+            std::initializer_list<int>{
+                (submit<Is>(state, executor,
+                            std::integral_constant<bool, async_slot<Args>::deferred>()),
+                 0)...};
+        }
+
+      public:
+        explicit async_construction(Args&&... args)
+            : slots(async_slot<Args>(std::move(args))...), remaining(1) {
+            for (bool deferred : {false, async_slot<Args>::deferred...}) {
+                remaining += deferred ? 1 : 0;
+            }
+        }
+
+        template <class Executor>
+        static std::future<result_t> launch(Executor& executor, Args&&... args) {
+            auto state = std::make_shared<async_construction>(std::move(args)...);
+            auto future = state->promise.get_future();
+            start(state, executor, indices());
+            state->finish();  // the construction can complete once all tasks are submitted
+            return future;
+        }
+    };
+}  // namespace helper
+
+//==================================================================================================
+template <class MD = no_metadata, class Executor, class... Args>
+auto make_tagged_tuple_async(Executor&& executor, Args&&... args) {
+    return helper::async_construction<MD, std::decay_t<Args>...>::launch(
+        executor, std::decay_t<Args>(std::forward<Args>(args))...);
+}
@@ -0,0 +1,155 @@
+/*Copyright or © or Copr. CNRS (2019). Contributors:
+- Vincent Lanore. vincent.lanore@gmail.com
+
+This software is a computer program whose purpose is to provide header-only library to create tuple
+indexed by type tags.
+
+This software is governed by the CeCILL-C license under French law and abiding by the rules of
+distribution of free software. You can use, modify and/ or redistribute the software under the terms
+of the CeCILL-C license as circulated by CEA, CNRS and INRIA at the following URL
+"http://www.cecill.info".
+
+As a counterpart to the access to the source code and rights to copy, modify and redistribute
+granted by the license, users are provided only with a limited warranty and the software's author,
+the holder of the economic rights, and the successive licensors have only limited liability.
+
+In this respect, the user's attention is drawn to the risks associated with loading, using,
+modifying and/or developing or reproducing the software by the user in light of its specific status
+of free software, that may mean that it is complicated to manipulate, and that also therefore means
+that it is reserved for developers and experienced professionals having in-depth computer knowledge.
+Users are therefore encouraged to load and test the software's suitability as regards their
+requirements in conditions enabling the security of their systems and/or data to be ensured and,
+more generally, to use and operate it in the same conditions as regards security.
+
+The fact that you are presently reading this means that you have had knowledge of the CeCILL-C
+license and that you accept its terms.*/
+
+#pragma once
+
+#include <atomic>
+#include "tagged_tuple.hpp"
+
+/* Fields listed in the concurrent property of a tuple's metadata are stored as std::atomic and must
+be accessed through the functions below (get<Key> on them does not compile). Example:
+    using md = metadata<type_list<>, type_map<property<concurrent, type_list<counter_>>>>;
+    auto t = make_tagged_tuple<md>(value_field<counter_>(0), value_field<step_>(0.1));
+    fetch_add<counter_>(t, 1); */
+
+//==================================================================================================
+// storage of concurrent fields; copies (used when building tuples) are not atomic as a whole
+template <class T>
+class atomic_value {
+  public:
+    std::atomic<T> value;
+
+    atomic_value() : value(T()) {}
+    atomic_value(T value) : value(value) {}
+    atomic_value(const atomic_value& other) : value(other.value.load(std::memory_order_relaxed)) {}
+    atomic_value& operator=(const atomic_value& other) {
+        value.store(other.value.load(std::memory_order_relaxed), std::memory_order_relaxed);
+        return *this;
+    }
+};
+
+// generic field walkers (e.g. visit_by_name) see the std::atomic
+template <class T>
+auto& deref_if_ptr(atomic_value<T>& x) {
+    return x.value;
+}
+
+template <class T>
+const auto& deref_if_ptr(const atomic_value<T>& x) {
+    return x.value;
+}
+
+//==================================================================================================
+namespace helper {
+    template <class Key, class TTuple>
+    constexpr size_t concurrent_field_index() {
+        static_assert(metadata_field_has_property<concurrent, Key, metadata_t<TTuple>>::value,
+                      "Field is not declared concurrent in the tuple metadata");
+        return map_element_index<Key, field_map_t<TTuple>>::value;
+    }
+
+    template <class T>
+    T atomic_fetch_add(std::atomic<T>& a, T arg, std::memory_order order, std::true_type) {
+        return a.fetch_add(arg, order);
+    }
+
+    // std::atomic<floating point>::fetch_add only exists from C++20
+    template <class T>
+    T atomic_fetch_add(std::atomic<T>& a, T arg, std::memory_order order, std::false_type) {
+        T expected = a.load(std::memory_order_relaxed);
+        while (not a.compare_exchange_weak(expected, expected + arg, order,
+                                           std::memory_order_relaxed)) {
+        }
+        return expected;
+    }
+
+    template <class T>
+    T atomic_fetch_sub(std::atomic<T>& a, T arg, std::memory_order order, std::true_type) {
+        return a.fetch_sub(arg, order);
+    }
+
+    template <class T>
+    T atomic_fetch_sub(std::atomic<T>& a, T arg, std::memory_order order, std::false_type) {
+        T expected = a.load(std::memory_order_relaxed);
+        while (not a.compare_exchange_weak(expected, expected - arg, order,
+                                           std::memory_order_relaxed)) {
+        }
+        return expected;
+    }
+}  // namespace helper
+
+// the std::atomic storing a concurrent field
+template <class Key, class TTuple>
+auto& atomic_field(TTuple& t) {
+    constexpr size_t index = helper::concurrent_field_index<Key, std::remove_const_t<TTuple>>();
+    return deref_if_ptr(get<index>(t.data));
+}
+
+template <class Key, class TTuple>
+auto load(const TTuple& t, std::memory_order order = std::memory_order_seq_cst) {
+    return atomic_field<Key>(t).load(order);
+}
+
+template <class Key, class TTuple, class T>
+void store(TTuple& t, T value, std::memory_order order = std::memory_order_seq_cst) {
+    atomic_field<Key>(t).store(value, order);
+}
+
+template <class Key, class TTuple, class T>
+auto exchange(TTuple& t, T value, std::memory_order order = std::memory_order_seq_cst) {
+    return atomic_field<Key>(t).exchange(value, order);
+}
+
+// returns the previous value; also available for floating point fields
+template <class Key, class TTuple, class T>
+auto fetch_add(TTuple& t, T arg, std::memory_order order = std::memory_order_seq_cst) {
+    auto& a = atomic_field<Key>(t);
+    using value_t = decltype(a.load());
+    return helper::atomic_fetch_add(a, static_cast<value_t>(arg), order,
+                                    std::is_integral<value_t>());
+}
+
+// (arg is converted to the field type before subtracting: fetch_sub<Key>(t, 1u) on a double field
+// subtracts 1)
+template <class Key, class TTuple, class T>
+auto fetch_sub(TTuple& t, T arg, std::memory_order order = std::memory_order_seq_cst) {
+    auto& a = atomic_field<Key>(t);
+    using value_t = decltype(a.load());
+    return helper::atomic_fetch_sub(a, static_cast<value_t>(arg), order,
+                                    std::is_integral<value_t>());
+}
+
+template <class Key, class TTuple, class T, class U>
+bool compare_exchange_weak(TTuple& t, T& expected, U desired,
+                           std::memory_order order = std::memory_order_seq_cst) {
+    return atomic_field<Key>(t).compare_exchange_weak(expected, desired, order);
+}
+
+template <class Key, class TTuple, class T, class U>
+bool compare_exchange_strong(TTuple& t, T& expected, U desired,
+                             std::memory_order order = std::memory_order_seq_cst) {
+    return atomic_field<Key>(t).compare_exchange_strong(expected, desired, order);
+}
@@ -0,0 +1,541 @@
+/*Copyright or © or Copr. CNRS (2019). Contributors:
+- Vincent Lanore. vincent.lanore@gmail.com
+
+This software is a computer program whose purpose is to provide header-only library to create tuple
+indexed by type tags.
+
+This software is governed by the CeCILL-C license under French law and abiding by the rules of
+distribution of free software. You can use, modify and/ or redistribute the software under the terms
+of the CeCILL-C license as circulated by CEA, CNRS and INRIA at the following URL
+"http://www.cecill.info".
+
+As a counterpart to the access to the source code and rights to copy, modify and redistribute
+granted by the license, users are provided only with a limited warranty and the software's author,
+the holder of the economic rights, and the successive licensors have only limited liability.
+
+In this respect, the user's attention is drawn to the risks associated with loading, using,
+modifying and/or developing or reproducing the software by the user in light of its specific status
+of free software, that may mean that it is complicated to manipulate, and that also therefore means
+that it is reserved for developers and experienced professionals having in-depth computer knowledge.
+Users are therefore encouraged to load and test the software's suitability as regards their
+requirements in conditions enabling the security of their systems and/or data to be ensured and,
+more generally, to use and operate it in the same conditions as regards security.
+
+The fact that you are presently reading this means that you have had knowledge of the CeCILL-C
+license and that you accept its terms.*/
+
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <cstring>
+#include <string>
+#include <vector>
+#include "bitwise_traits.hpp"
+#include "schema_hash.hpp"
+#include "visit_by_name.hpp"
+
+/* Binary encoding of tagged tuples that survives schema changes. A tuple is written as:
+    uint64 schema hash, uint8 raw flag, uint32 number of fields,
+    per field: uint32 name size, name, uint64 type id, uint64 offset and size in the payload,
+    uint64 payload size, payload.
+When all fields are arithmetic or enums and the storage has no padding, the payload is the bytes
+of the tuple storage (raw flag set); otherwise fields are encoded one after the other. Decoding
+copies the payload as is (with a single memcpy if the storage is trivially copyable) when the
+stored schema hash is the current one, both sides are raw and no field is a bool. Otherwise it maps
+stored fields to current fields by tag name: fields with the same name and type id are decoded,
+unknown or retyped ones are skipped, and current fields absent from the input get their default
+value (null for pointers; reference fields are left alone). Nested tuples carry their own header,
+so they evolve independently. Numbers are in host byte order. Fields are encoded as their
+declared type through field_value_ptr, so atomic, cache-line isolated and pooled fields are
+supported. Supported field types: arithmetic types, enums, std::string, std::vector (including
+std::vector<bool>) and std::unique_ptr of supported types, and nested tagged tuples.
+Lengths in the input are checked against its size before allocating. */
+
+//==================================================================================================
+// type ids and schema hash
+
+namespace helper {
+    template <class T>
+    struct binary_type_id {
+        static constexpr uint64_t value = stable_type_hash<T>::value;
+    };
+
+    // nested tuples all have the same field type id: their own header handles schema changes
+    template <class MD, class... Fields>
+    struct binary_type_id<tagged_tuple<MD, Fields...>> {
+        static constexpr uint64_t value = fnv1a("tagged_tuple");
+    };
+
+    template <class T>
+    constexpr uint64_t binary_type_id<T>::value;
+
+    template <class MD, class... Fields>
+    constexpr uint64_t binary_type_id<tagged_tuple<MD, Fields...>>::value;
+
+    template <class TTuple>
+    struct binary_schema;
+
+    template <class MD, class... Fields>
+    struct binary_schema<tagged_tuple<MD, Fields...>> {
+        static constexpr uint64_t hash() { return schema_hash<tagged_tuple<MD, Fields...>>; }
+
+        // payload is the tuple storage itself (padding bytes would make the output depend on
+        // whatever they happen to contain)
+        static constexpr bool raw =
+            all_true<std::integral_constant<
+                bool, std::is_arithmetic<storage_t<MD, Fields>>::value or
+                          std::is_enum<storage_t<MD, Fields>>::value>...>::value and
+            sizeof(tagged_tuple<MD, Fields...>) == sum_of_sizes<storage_t<MD, Fields>...>();
+
+        // a raw payload with the same layout can be copied as is (bytes copied into a bool field
+        // could be neither true nor false), at once if the storage is trivially copyable
+        static constexpr bool raw_decodable =
+            raw and all_true<std::integral_constant<
+                        bool, not std::is_same<storage_t<MD, Fields>, bool>::value>...>::value;
+    };
+
+    template <class MD, class... Fields>
+    constexpr bool binary_schema<tagged_tuple<MD, Fields...>>::raw;
+
+    template <class MD, class... Fields>
+    constexpr bool binary_schema<tagged_tuple<MD, Fields...>>::raw_decodable;
+}  // namespace helper
+
+//==================================================================================================
+// encoding
+
+template <class T>
+void write_binary_bytes(std::string& out, const T& value) {
+    out.append(reinterpret_cast<const char*>(&value), sizeof(T));
+}
+
+template <class T,
+          class = std::enable_if_t<std::is_arithmetic<T>::value or std::is_enum<T>::value>>
+void write_binary(std::string& out, T value) {
+    write_binary_bytes(out, value);
+}
+
+// concurrent fields
+template <class T>
+void write_binary(std::string& out, const std::atomic<T>& value) {
+    write_binary(out, value.load(std::memory_order_relaxed));
+}
+
+inline void write_binary(std::string& out, const std::string& value) {
+    write_binary_bytes(out, uint64_t(value.size()));
+    out += value;
+}
+
+// one byte per element (the elements of std::vector<bool> are proxies)
+inline void write_binary(std::string& out, const std::vector<bool>& value) {
+    write_binary_bytes(out, uint64_t(value.size()));
+    for (bool element : value) { write_binary(out, element); }
+}
+
+template <class T>
+void write_binary(std::string& out, const std::vector<T>& value);
+
+template <class T>
+void write_binary(std::string& out, const std::unique_ptr<T>& value);
+
+template <class MD, class... Fields>
+void write_binary(std::string& out, const tagged_tuple<MD, Fields...>& t);
+
+namespace helper {
+    template <class T>
+    void write_binary_elements(std::string& out, const std::vector<T>& value,
+                               std::true_type /* contiguous bytes */) {
+        out.append(reinterpret_cast<const char*>(value.data()), value.size() * sizeof(T));
+    }
+
+    template <class T>
+    void write_binary_elements(std::string& out, const std::vector<T>& value,
+                               std::false_type /* contiguous bytes */) {
+        for (auto& element : value) { write_binary(out, element); }
+    }
+
+    template <class T>
+    using is_binary_bytes = std::integral_constant<bool, (std::is_arithmetic<T>::value or
+                                                          std::is_enum<T>::value) and
+                                                             not std::is_same<T, bool>::value>;
+}  // namespace helper
+
+template <class T>
+void write_binary(std::string& out, const std::vector<T>& value) {
+    write_binary_bytes(out, uint64_t(value.size()));
+    helper::write_binary_elements(out, value, helper::is_binary_bytes<T>());
+}
+
+template <class T>
+void write_binary(std::string& out, const std::unique_ptr<T>& value) {
+    write_binary_bytes(out, uint8_t(value != nullptr));
+    if (value != nullptr) { write_binary(out, static_cast<const T&>(*value)); }
+}
+
+namespace helper {
+    // offset and size in the payload of each field, in field order
+    struct binary_field_position {
+        uint64_t offset, size;
+    };
+
+    template <class TTuple, size_t... Is>
+    std::array<binary_field_position, sizeof...(Is)> binary_raw_positions(
+        const TTuple& t, std::index_sequence<Is...>) {
+        auto base = reinterpret_cast<const char*>(&t.data);
+        return {{{uint64_t(reinterpret_cast<const char*>(&get<Is>(t.data)) - base),
+                  sizeof(get<Is>(t.data))}...}};
+    }
+
+    template <class TTuple, size_t... Is>
+    void write_binary_payload(std::string& out, const TTuple& t,
+                              std::array<binary_field_position, sizeof...(Is)>& positions,
+                              std::true_type /* raw */, std::index_sequence<Is...> is) {
+        positions = binary_raw_positions(t, is);
+        write_binary_bytes(out, t.data);
+    }
+
+    // nullable fields are preceded by a presence byte, as std::unique_ptr values
+    template <class T>
+    void write_binary_field(std::string& out, const T& field) {
+        auto value = field_value_ptr(field);
+        if (is_nullable_field<T>::value) { write_binary_bytes(out, uint8_t(value != nullptr)); }
+        if (value != nullptr) { write_binary(out, *value); }
+    }
+
+    template <class TTuple, size_t... Is>
+    void write_binary_payload(std::string& out, const TTuple& t,
+                              std::array<binary_field_position, sizeof...(Is)>& positions,
+                              std::false_type /* raw */, std::index_sequence<Is...>) {
+        size_t start = out.size();
+        std::initializer_list<int>{(positions[Is].offset = out.size() - start,
+                                    write_binary_field(out, get<Is>(t.data)),
+                                    positions[Is].size = out.size() - start - positions[Is].offset,
+                                    0)...};
+    }
+}  // namespace helper
+
+template <class MD, class... Fields>
+void write_binary(std::string& out, const tagged_tuple<MD, Fields...>& t) {
+    using schema = helper::binary_schema<tagged_tuple<MD, Fields...>>;
+    constexpr size_t nb_fields = sizeof...(Fields);
+    constexpr auto names = field_names<tagged_tuple<MD, Fields...>>();
+    const uint64_t type_ids[] = {0, helper::binary_type_id<second_t<Fields>>::value...};
+
+    std::string payload;
+    std::array<helper::binary_field_position, nb_fields> positions;
+    helper::write_binary_payload(payload, t, positions,
+                                 std::integral_constant<bool, schema::raw>(),
+                                 std::index_sequence_for<Fields...>());
+
+    write_binary_bytes(out, schema::hash());
+    write_binary_bytes(out, uint8_t(schema::raw));
+    write_binary_bytes(out, uint32_t(nb_fields));
+    for (size_t i = 0; i < nb_fields; i++) {
+        write_binary_bytes(out, uint32_t(names[i].size()));
+        out.append(names[i].data(), names[i].size());
+        write_binary_bytes(out, type_ids[i + 1]);
+        write_binary_bytes(out, positions[i].offset);
+        write_binary_bytes(out, positions[i].size);
+    }
+    write_binary_bytes(out, uint64_t(payload.size()));
+    out += payload;
+}
+
+template <class T>
+std::string to_binary(const T& value) {
+    std::string result;
+    write_binary(result, value);
+    return result;
+}
+
+//==================================================================================================
+// decoding
+
+class binary_reader {
+    const char* pos;
+    const char* end;
+
+  public:
+    explicit binary_reader(const_string data) : pos(data.data()), end(data.data() + data.size()) {}
+
+    bool read_bytes(void* out, size_t n) {
+        if (size_t(end - pos) < n) { return false; }
+        std::memcpy(out, pos, n);
+        pos += n;
+        return true;
+    }
+
+    template <class T>
+    bool read_bytes(T& value) {
+        return read_bytes(&value, sizeof(T));
+    }
+
+    // next n bytes, consumed
+    bool read_view(size_t n, const_string& out) {
+        if (size_t(end - pos) < n) { return false; }
+        out = const_string(pos, n);
+        pos += n;
+        return true;
+    }
+
+    size_t remaining() const { return size_t(end - pos); }
+    bool at_end() const { return pos == end; }
+};
+
+template <class T,
+          class = std::enable_if_t<std::is_arithmetic<T>::value or std::is_enum<T>::value>>
+bool read_binary(binary_reader& reader, T& value) {
+    return reader.read_bytes(value);
+}
+
+// bytes other than 0 and 1 are rejected
+inline bool read_binary(binary_reader& reader, bool& value) {
+    uint8_t byte;
+    if (not reader.read_bytes(byte) or byte > 1) { return false; }
+    value = byte == 1;
+    return true;
+}
+
+template <class T>
+bool read_binary(binary_reader& reader, std::atomic<T>& value) {
+    T result;
+    if (not read_binary(reader, result)) { return false; }
+    value.store(result, std::memory_order_relaxed);
+    return true;
+}
+
+inline bool read_binary(binary_reader& reader, std::string& value) {
+    uint64_t size;
+    const_string bytes;
+    if (not reader.read_bytes(size) or not reader.read_view(size, bytes)) { return false; }
+    value.assign(bytes.data(), bytes.size());
+    return true;
+}
+
+inline bool read_binary(binary_reader& reader, std::vector<bool>& value) {
+    uint64_t size;
+    if (not reader.read_bytes(size) or size > reader.remaining()) { return false; }
+    value.assign(size, false);
+    for (size_t i = 0; i < size; i++) {
+        bool element;
+        if (not read_binary(reader, element)) { return false; }
+        value[i] = element;
+    }
+    return true;
+}
+
+template <class T>
+bool read_binary(binary_reader& reader, std::vector<T>& value);
+
+template <class T>
+bool read_binary(binary_reader& reader, std::unique_ptr<T>& value);
+
+template <class MD, class... Fields>
+bool read_binary(binary_reader& reader, tagged_tuple<MD, Fields...>& t);
+
+namespace helper {
+    template <class T>
+    bool read_binary_elements(binary_reader& reader, std::vector<T>& value,
+                              std::true_type /* contiguous bytes */) {
+        return value.empty() or reader.read_bytes(value.data(), value.size() * sizeof(T));
+    }
+
+    template <class T>
+    bool read_binary_elements(binary_reader& reader, std::vector<T>& value,
+                              std::false_type /* contiguous bytes */) {
+        for (auto& element : value) {
+            if (not read_binary(reader, element)) { return false; }
+        }
+        return true;
+    }
+}  // namespace helper
+
+template <class T>
+bool read_binary(binary_reader& reader, std::vector<T>& value) {
+    // every element takes at least one byte: larger sizes are malformed, not worth allocating
+    const size_t min_element_size = helper::is_binary_bytes<T>::value ? sizeof(T) : 1;
+    uint64_t size;
+    if (not reader.read_bytes(size) or size > reader.remaining() / min_element_size) {
+        return false;
+    }
+    value.clear();
+    value.resize(size);
+    return helper::read_binary_elements(reader, value, helper::is_binary_bytes<T>());
+}
+
+template <class T>
+bool read_binary(binary_reader& reader, std::unique_ptr<T>& value) {
+    uint8_t engaged;
+    if (not reader.read_bytes(engaged)) { return false; }
+    if (not engaged) {
+        value.reset();
+        return true;
+    }
+    if (value == nullptr) { value = std::make_unique<T>(); }
+    return read_binary(reader, *value);
+}
+
+namespace helper {
+    template <size_t I, class TTuple>
+    bool read_binary_field(binary_reader& reader, TTuple& t) {
+        auto& field = get<I>(t.data);
+        using field_t = std::remove_reference_t<decltype(field)>;
+        if (is_nullable_field<field_t>::value) {
+            uint8_t engaged;
+            if (not reader.read_bytes(engaged)) { return false; }
+            if (not engaged) { return reset_field(field); }
+        }
+        auto value = emplace_field_value(field);
+        return value != nullptr and read_binary(reader, *value);
+    }
+
+    template <class TTuple, size_t... Is>
+    bool read_binary_field(binary_reader& reader, TTuple& t, size_t index,
+                           std::index_sequence<Is...>) {
+        using fun_t = bool (*)(binary_reader&, TTuple&);
+        static constexpr fun_t table[sizeof...(Is) + 1] = {&read_binary_field<Is, TTuple>...,
+                                                           nullptr};
+        return table[index](reader, t);
+    }
+
+    template <class T>
+    void assign_default(T& value) {
+        value = T();
+    }
+
+    template <class T>
+    void assign_default(std::atomic<T>& value) {
+        value.store(T(), std::memory_order_relaxed);
+    }
+
+    // (a non-null raw pointer is left alone: its pointee is not part of the tuple)
+    template <class T>
+    void reset_binary_field(T& field, std::true_type /* nullable */) {
+        reset_field(field);
+    }
+
+    template <class T>
+    void reset_binary_field(T& field, std::false_type /* nullable */) {
+        assign_default(deref_if_ptr(field));
+    }
+
+    template <class TTuple, size_t... Is>
+    void reset_binary_fields(TTuple& t, const bool* read, std::index_sequence<Is...>) {
+        std::initializer_list<int>{
+            (read[Is] ? 0
+                      : (reset_binary_field(get<Is>(t.data),
+                                            is_nullable_field<std::remove_reference_t<decltype(
+                                                get<Is>(t.data))>>()),
+                         0))...};
+    }
+
+    template <class TTuple, class Positions, size_t... Is>
+    void copy_binary_raw(TTuple& t, const_string payload, const Positions&,
+                         std::true_type /* trivially copyable storage */,
+                         std::index_sequence<Is...>) {
+        std::memcpy(&t.data, payload.data(), sizeof(t.data));
+    }
+
+    template <class TTuple, class Positions, size_t... Is>
+    void copy_binary_raw(TTuple& t, const_string payload, const Positions& positions,
+                         std::false_type /* trivially copyable storage */,
+                         std::index_sequence<Is...>) {
+        std::initializer_list<int>{(std::memcpy(&get<Is>(t.data),
+                                                payload.data() + positions[Is].offset,
+                                                sizeof(get<Is>(t.data))),
+                                    0)...};
+    }
+
+    template <class TTuple, class Positions, class Is>
+    bool read_binary_raw(TTuple& t, const_string payload, const Positions& positions,
+                         std::true_type /* decodable */, Is is) {
+        using storage = decltype(t.data);
+        copy_binary_raw(t, payload, positions, std::is_trivially_copyable<storage>(), is);
+        return true;
+    }
+
+    template <class TTuple, class Positions, class Is>
+    bool read_binary_raw(TTuple&, const_string, const Positions&,
+                         std::false_type /* decodable */, Is) {
+        return false;  // decoded and checked field by field
+    }
+}  // namespace helper
+
+// stored fields unknown to the current tuple, or with another type, are skipped; current fields
+// absent from the input, or retyped, get their default value
+template <class MD, class... Fields>
+bool read_binary(binary_reader& reader, tagged_tuple<MD, Fields...>& t) {
+    using tuple_t = tagged_tuple<MD, Fields...>;
+    using schema = helper::binary_schema<tuple_t>;
+    const uint64_t type_ids[] = {0, helper::binary_type_id<second_t<Fields>>::value...};
+
+    uint64_t hash;
+    uint8_t raw;
+    uint32_t nb_fields;
+    if (not reader.read_bytes(hash) or not reader.read_bytes(raw) or
+        not reader.read_bytes(nb_fields)) {
+        return false;
+    }
+    struct stored_field {
+        const_string name;
+        uint64_t type_id, offset, size;
+    };
+    // each field description takes at least 28 bytes
+    if (nb_fields > reader.remaining() / 28) { return false; }
+    std::vector<stored_field> stored(nb_fields);
+    for (auto& field : stored) {
+        uint32_t name_size;
+        if (not reader.read_bytes(name_size) or not reader.read_view(name_size, field.name) or
+            not reader.read_bytes(field.type_id) or not reader.read_bytes(field.offset) or
+            not reader.read_bytes(field.size)) {
+            return false;
+        }
+    }
+    uint64_t payload_size;
+    const_string payload;
+    if (not reader.read_bytes(payload_size) or not reader.read_view(payload_size, payload)) {
+        return false;
+    }
+
+    bool same_schema = hash == schema::hash() and nb_fields == sizeof...(Fields);
+    if (same_schema and raw and schema::raw and payload.size() == sizeof(t.data)) {
+        // same layout too (std::tuple layouts differ between standard libraries)
+        auto positions = helper::binary_raw_positions(t, std::index_sequence_for<Fields...>());
+        bool same_layout = true;
+        for (size_t i = 0; i < stored.size(); i++) {
+            same_layout = same_layout and stored[i].offset == positions[i].offset;
+        }
+        if (same_layout and
+            helper::read_binary_raw(t, payload, positions,
+                                    std::integral_constant<bool, schema::raw_decodable>(),
+                                    std::index_sequence_for<Fields...>())) {
+            return true;
+        }
+    }
+    // reference fields count as read: their referent is not part of the tuple, so it is not reset
+    bool read[sizeof...(Fields) + 1] = {std::is_reference<second_t<Fields>>::value..., false};
+    for (size_t i = 0; i < stored.size(); i++) {
+        auto& field = stored[i];
+        int index = same_schema ? int(i) : field_index_by_name<tuple_t>(field.name);
+        if (index < 0 or type_ids[index + 1] != field.type_id) { continue; }
+        if (field.offset > payload.size() or field.size > payload.size() - field.offset) {
+            return false;
+        }
+        binary_reader field_reader(payload.substr(field.offset, field.size));
+        if (not helper::read_binary_field(field_reader, t, index,
+                                          std::index_sequence_for<Fields...>())) {
+            return false;
+        }
+        read[index] = true;
+    }
+    helper::reset_binary_fields(t, read, std::index_sequence_for<Fields...>());
+    return true;
+}
+
+// returns false if data is malformed (value may then be partially updated)
+template <class T>
+bool from_binary(T& value, const_string data) {
+    binary_reader reader(data);
+    return read_binary(reader, value) and reader.at_end();
+}
@@ -0,0 +1,74 @@
+/*Copyright or © or Copr. CNRS (2019). Contributors:
+- Vincent Lanore. vincent.lanore@gmail.com
+
+This software is a computer program whose purpose is to provide header-only library to create tuple
+indexed by type tags.
+
+This software is governed by the CeCILL-C license under French law and abiding by the rules of
+distribution of free software. You can use, modify and/ or redistribute the software under the terms
+of the CeCILL-C license as circulated by CEA, CNRS and INRIA at the following URL
+"http://www.cecill.info".
+
+As a counterpart to the access to the source code and rights to copy, modify and redistribute
+granted by the license, users are provided only with a limited warranty and the software's author,
+the holder of the economic rights, and the successive licensors have only limited liability.
+
+In this respect, the user's attention is drawn to the risks associated with loading, using,
+modifying and/or developing or reproducing the software by the user in light of its specific status
+of free software, that may mean that it is complicated to manipulate, and that also therefore means
+that it is reserved for developers and experienced professionals having in-depth computer knowledge.
+Users are therefore encouraged to load and test the software's suitability as regards their
+requirements in conditions enabling the security of their systems and/or data to be ensured and,
+more generally, to use and operate it in the same conditions as regards security.
+
+The fact that you are presently reading this means that you have had knowledge of the CeCILL-C
+license and that you accept its terms.*/
+
+#pragma once
+
+#include "tagged_tuple.hpp"
+
+/* Compile-time properties of field storage used to select bulk-bytes fast paths (hashing,
+comparison, copies). */
+
+//==================================================================================================
+namespace helper {
+    template <class MD, class Field>
+    using storage_t = second_t<storage_field_t<MD, Field>>;
+
+    template <class... Ts>
+    struct all_true : std::true_type {};
+
+    template <class T, class... Ts>
+    struct all_true<T, Ts...>
+        : std::integral_constant<bool, T::value and all_true<Ts...>::value> {};
+
+    template <class... Ts>
+    constexpr size_t sum_of_sizes() {
+        size_t result = 0;
+        for (size_t size : {size_t(0), sizeof(Ts)...}) { result += size; }
+        return result;
+    }
+}  // namespace helper
+
+// types whose equality is equality of their object representation: integers and enums, and
+// tagged tuples of such types without padding bytes. Floating point types are excluded (0.0 ==
+// -0.0, nan != nan) as are pointers (tagged tuples compare pointer fields by pointee).
+template <class T>
+struct is_bitwise_comparable
+    : std::integral_constant<bool, std::is_integral<T>::value or std::is_enum<T>::value> {};
+
+template <class MD, class... Fields>
+struct is_bitwise_comparable<tagged_tuple<MD, Fields...>>
+    : std::integral_constant<
+          bool, helper::all_true<is_bitwise_comparable<helper::storage_t<MD, Fields>>...>::value and
+                    sizeof(tagged_tuple<MD, Fields...>) ==
+                        helper::sum_of_sizes<helper::storage_t<MD, Fields>...>()> {};
+
+// tagged tuples whose fields can all be copied with memcpy
+template <class TTuple>
+struct has_trivially_copyable_fields;
+
+template <class MD, class... Fields>
+struct has_trivially_copyable_fields<tagged_tuple<MD, Fields...>>
+    : helper::all_true<std::is_trivially_copyable<helper::storage_t<MD, Fields>>...> {};
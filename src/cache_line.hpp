@@ -0,0 +1,183 @@
+/*Copyright or © or Copr. CNRS (2019). Contributors:
+- Vincent Lanore. vincent.lanore@gmail.com
+
+This software is a computer program whose purpose is to provide header-only library to create tuple
+indexed by type tags.
+
+This software is governed by the CeCILL-C license under French law and abiding by the rules of
+distribution of free software. You can use, modify and/ or redistribute the software under the terms
+of the CeCILL-C license as circulated by CEA, CNRS and INRIA at the following URL
+"http://www.cecill.info".
+
+As a counterpart to the access to the source code and rights to copy, modify and redistribute
+granted by the license, users are provided only with a limited warranty and the software's author,
+the holder of the economic rights, and the successive licensors have only limited liability.
+
+In this respect, the user's attention is drawn to the risks associated with loading, using,
+modifying and/or developing or reproducing the software by the user in light of its specific status
+of free software, that may mean that it is complicated to manipulate, and that also therefore means
+that it is reserved for developers and experienced professionals having in-depth computer knowledge.
+Users are therefore encouraged to load and test the software's suitability as regards their
+requirements in conditions enabling the security of their systems and/or data to be ensured and,
+more generally, to use and operate it in the same conditions as regards security.
+
+The fact that you are presently reading this means that you have had knowledge of the CeCILL-C
+license and that you accept its terms.*/
+
+#pragma once
+
+#include <array>
+#include <vector>
+#include "layout.hpp"
+#include "tag_name.hpp"
+
+/* Fields listed in the cache_line_isolated property of a tuple's metadata are stored in an
+isolated_value, aligned on and padded to whole cache lines, so that no other field shares a line
+with them (e.g. per-thread accumulators). get<Key> is unaffected. Note that in C++14, operator new
+does not honor alignments above alignof(std::max_align_t): heap-allocated tuples with isolated
+fields need an aligned allocation to actually start on a line boundary. */
+
+constexpr size_t cache_line_size = 64;
+
+//==================================================================================================
+template <class T>
+class alignas(cache_line_size) isolated_value {
+  public:
+    T value;
+
+    isolated_value() : value() {}
+    isolated_value(const isolated_value&) = default;
+    isolated_value(isolated_value&&) = default;
+    isolated_value& operator=(const isolated_value&) = default;
+    isolated_value& operator=(isolated_value&&) = default;
+
+    template <class U, class = std::enable_if_t<
+                           not std::is_same<std::decay_t<U>, isolated_value>::value and
+                           std::is_constructible<T, U&&>::value>>
+    isolated_value(U&& value) : value(std::forward<U>(value)) {}
+};
+
+template <class T>
+auto& deref_if_ptr(isolated_value<T>& x) {
+    return deref_if_ptr(x.value);
+}
+
+template <class T>
+const auto& deref_if_ptr(const isolated_value<T>& x) {
+    return deref_if_ptr(x.value);
+}
+
+template <class T>
+bool is_null_field(const isolated_value<T>& x) {
+    return is_null_field(x.value);
+}
+
+template <class T>
+struct is_nullable_field<isolated_value<T>> : is_nullable_field<T> {};
+
+template <class T>
+auto emplace_field_value(isolated_value<T>& x) {
+    return emplace_field_value(x.value);
+}
+
+template <class T>
+bool reset_field(isolated_value<T>& x) {
+    return reset_field(x.value);
+}
+
+//==================================================================================================
+// compile-time view: which fields are isolated
+
+template <class Tag, class TTuple>
+using is_cache_line_isolated =
+    metadata_field_has_property<cache_line_isolated, Tag, metadata_t<TTuple>>;
+
+namespace helper {
+    template <class TTuple>
+    struct isolated_fields_impl;
+
+    template <class MD, class... Fields>
+    struct isolated_fields_impl<tagged_tuple<MD, Fields...>> {
+        using tuple_t = tagged_tuple<MD, Fields...>;
+        static constexpr std::array<bool, sizeof...(Fields)> get() {
+            return {{is_cache_line_isolated<first_t<Fields>, tuple_t>::value...}};
+        }
+    };
+}  // namespace helper
+
+template <class TTuple>
+constexpr std::array<bool, tuple_nb_fields<TTuple>::value> isolated_fields() {
+    return helper::isolated_fields_impl<TTuple>::get();
+}
+
+namespace helper {
+    // byte ranges [offset, offset + size) from the start of an object; exact if the object starts
+    // on a line boundary, otherwise true if they share a line for some placement of the object
+    constexpr bool ranges_may_share_line(size_t offset1, size_t size1, size_t offset2,
+                                         size_t size2, bool line_aligned) {
+        if (offset2 < offset1) {
+            return ranges_may_share_line(offset2, size2, offset1, size1, line_aligned);
+        }
+        size_t last1 = offset1 + (size1 == 0 ? 0 : size1 - 1);
+        if (offset2 <= last1) { return true; }
+        return line_aligned ? last1 / cache_line_size == offset2 / cache_line_size
+                            : offset2 - last1 < cache_line_size;
+    }
+}  // namespace helper
+
+// compile-time counterpart of cache_line_report for tuples with the standard_layout metadata tag:
+// can fields Key1 and Key2 share a cache line? (exact for tuples aligned on cache lines)
+template <class TTuple, class Key1, class Key2>
+constexpr bool may_share_cache_line() {
+    constexpr auto offsets = field_offsets<TTuple>();
+    constexpr auto sizes = field_sizes<TTuple>();
+    constexpr size_t i1 = map_element_index<Key1, field_map_t<TTuple>>::value;
+    constexpr size_t i2 = map_element_index<Key2, field_map_t<TTuple>>::value;
+    return helper::ranges_may_share_line(offsets[i1], sizes[i1], offsets[i2], sizes[i2],
+                                         alignof(TTuple) % cache_line_size == 0);
+}
+
+//==================================================================================================
+// cache line occupancy of the fields of an actual tuple object
+
+struct cache_line_info {
+    const_string name;
+    size_t offset, size;          // in bytes, relative to the start of the tuple
+    size_t first_line, last_line;  // relative to the line containing the start of the tuple
+    std::vector<const_string> shares_line_with;
+};
+
+namespace helper {
+    template <class TTuple, size_t... Is>
+    std::vector<cache_line_info> cache_line_report(const TTuple& t, std::index_sequence<Is...>) {
+        constexpr auto names = field_names<TTuple>();
+        auto base = reinterpret_cast<uintptr_t>(&t);
+        auto line_base = base - base % cache_line_size;
+        std::vector<cache_line_info> result;
+        std::initializer_list<int>{(
+            result.push_back({names[Is], reinterpret_cast<uintptr_t>(&get<Is>(t.data)) - base,
+                              sizeof(get<Is>(t.data)), 0, 0, {}}),
+            0)...};
+        for (auto& info : result) {
+            info.first_line = (base + info.offset - line_base) / cache_line_size;
+            info.last_line =
+                (base + info.offset + (info.size == 0 ? 0 : info.size - 1) - line_base) /
+                cache_line_size;
+        }
+        for (auto& info : result) {
+            for (auto& other : result) {
+                if (&info != &other and info.first_line <= other.last_line and
+                    other.first_line <= info.last_line) {
+                    info.shares_line_with.push_back(other.name);
+                }
+            }
+        }
+        return result;
+    }
+}  // namespace helper
+
+// per field (in field order): position, lines occupied and names of fields sharing a line with it
+template <class MD, class... Fields>
+std::vector<cache_line_info> cache_line_report(const tagged_tuple<MD, Fields...>& t) {
+    return helper::cache_line_report(t, std::index_sequence_for<Fields...>());
+}
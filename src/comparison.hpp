@@ -0,0 +1,117 @@
+/*Copyright or © or Copr. CNRS (2019). Contributors:
+- Vincent Lanore. vincent.lanore@gmail.com
+
+This software is a computer program whose purpose is to provide header-only library to create tuple
+indexed by type tags.
+
+This software is governed by the CeCILL-C license under French law and abiding by the rules of
+distribution of free software. You can use, modify and/ or redistribute the software under the terms
+of the CeCILL-C license as circulated by CEA, CNRS and INRIA at the following URL
+"http://www.cecill.info".
+
+As a counterpart to the access to the source code and rights to copy, modify and redistribute
+granted by the license, users are provided only with a limited warranty and the software's author,
+the holder of the economic rights, and the successive licensors have only limited liability.
+
+In this respect, the user's attention is drawn to the risks associated with loading, using,
+modifying and/or developing or reproducing the software by the user in light of its specific status
+of free software, that may mean that it is complicated to manipulate, and that also therefore means
+that it is reserved for developers and experienced professionals having in-depth computer knowledge.
+Users are therefore encouraged to load and test the software's suitability as regards their
+requirements in conditions enabling the security of their systems and/or data to be ensured and,
+more generally, to use and operate it in the same conditions as regards security.
+
+The fact that you are presently reading this means that you have had knowledge of the CeCILL-C
+license and that you accept its terms.*/
+
+#pragma once
+
+#include <cstring>
+#include "bitwise_traits.hpp"
+
+/* Comparison operators for tagged tuples. Fields are compared in field order, through
+field_value_ptr: pointer-like fields (unique_ptr, raw pointers, pooled, shared and cow fields) are
+compared by pointee, two null pointers are equal and null is smaller than any non-null pointer.
+Equality of bitwise comparable tuples (see bitwise_traits.hpp) is a single memcmp of the
+storage. */
+
+//==================================================================================================
+// per-field comparisons (arguments are field storages)
+
+template <class T>
+bool field_equal(const T& a, const T& b) {
+    auto a_value = field_value_ptr(a);
+    auto b_value = field_value_ptr(b);
+    return (a_value == nullptr or b_value == nullptr) ? a_value == b_value : *a_value == *b_value;
+}
+
+template <class T>
+bool field_less(const T& a, const T& b) {
+    auto a_value = field_value_ptr(a);
+    auto b_value = field_value_ptr(b);
+    return (a_value == nullptr or b_value == nullptr) ? b_value != nullptr : *a_value < *b_value;
+}
+
+//==================================================================================================
+namespace helper {
+    template <class TTuple, size_t... Is>
+    bool tuple_equal(const TTuple& a, const TTuple& b, std::false_type /* is bitwise comparable */,
+                     std::index_sequence<Is...>) {
+        bool result = true;
+        std::initializer_list<int>{
+            (result = result and field_equal(get<Is>(a.data), get<Is>(b.data)), 0)...};
+        return result;
+    }
+
+    template <class TTuple, size_t... Is>
+    bool tuple_equal(const TTuple& a, const TTuple& b, std::true_type /* is bitwise comparable */,
+                     std::index_sequence<Is...>) {
+        return std::memcmp(&a.data, &b.data, sizeof(a.data)) == 0;
+    }
+
+    template <class TTuple>
+    bool tuple_less(const TTuple&, const TTuple&, std::index_sequence<>) {
+        return false;
+    }
+
+    template <class TTuple, size_t I, size_t... Is>
+    bool tuple_less(const TTuple& a, const TTuple& b, std::index_sequence<I, Is...>) {
+        auto& a_field = get<I>(a.data);
+        auto& b_field = get<I>(b.data);
+        if (field_less(a_field, b_field)) { return true; }
+        if (field_less(b_field, a_field)) { return false; }
+        return tuple_less(a, b, std::index_sequence<Is...>());
+    }
+}  // namespace helper
+
+template <class MD, class... Fields>
+bool operator==(const tagged_tuple<MD, Fields...>& a, const tagged_tuple<MD, Fields...>& b) {
+    return helper::tuple_equal(a, b, is_bitwise_comparable<tagged_tuple<MD, Fields...>>(),
+                               std::index_sequence_for<Fields...>());
+}
+
+template <class MD, class... Fields>
+bool operator!=(const tagged_tuple<MD, Fields...>& a, const tagged_tuple<MD, Fields...>& b) {
+    return not(a == b);
+}
+
+// lexicographic order, in field order
+template <class MD, class... Fields>
+bool operator<(const tagged_tuple<MD, Fields...>& a, const tagged_tuple<MD, Fields...>& b) {
+    return helper::tuple_less(a, b, std::index_sequence_for<Fields...>());
+}
+
+template <class MD, class... Fields>
+bool operator>(const tagged_tuple<MD, Fields...>& a, const tagged_tuple<MD, Fields...>& b) {
+    return b < a;
+}
+
+template <class MD, class... Fields>
+bool operator<=(const tagged_tuple<MD, Fields...>& a, const tagged_tuple<MD, Fields...>& b) {
+    return not(b < a);
+}
+
+template <class MD, class... Fields>
+bool operator>=(const tagged_tuple<MD, Fields...>& a, const tagged_tuple<MD, Fields...>& b) {
+    return not(a < b);
+}
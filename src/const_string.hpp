@@ -0,0 +1,99 @@
+/*Copyright or © or Copr. CNRS (2019). Contributors:
+- Vincent Lanore. vincent.lanore@gmail.com
+
+This software is a computer program whose purpose is to provide header-only library to create tuple
+indexed by type tags.
+
+This software is governed by the CeCILL-C license under French law and abiding by the rules of
+distribution of free software. You can use, modify and/ or redistribute the software under the terms
+of the CeCILL-C license as circulated by CEA, CNRS and INRIA at the following URL
+"http://www.cecill.info".
+
+As a counterpart to the access to the source code and rights to copy, modify and redistribute
+granted by the license, users are provided only with a limited warranty and the software's author,
+the holder of the economic rights, and the successive licensors have only limited liability.
+
+In this respect, the user's attention is drawn to the risks associated with loading, using,
+modifying and/or developing or reproducing the software by the user in light of its specific status
+of free software, that may mean that it is complicated to manipulate, and that also therefore means
+that it is reserved for developers and experienced professionals having in-depth computer knowledge.
+Users are therefore encouraged to load and test the software's suitability as regards their
+requirements in conditions enabling the security of their systems and/or data to be ensured and,
+more generally, to use and operate it in the same conditions as regards security.
+
+The fact that you are presently reading this means that you have had knowledge of the CeCILL-C
+license and that you accept its terms.*/
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+/* Non-owning view of a character string that can be built and compared at compile time (C++14
+has no std::string_view). Strings built from literals point to static storage, so copying a
+const_string never allocates. */
+
+class const_string {
+    const char* ptr;
+    size_t len;
+
+  public:
+    constexpr const_string() : ptr(""), len(0) {}
+    constexpr const_string(const char* ptr, size_t len) : ptr(ptr), len(len) {}
+    constexpr const_string(const char* s) : ptr(s), len(0) {
+        while (s[len] != '\0') { len++; }
+    }
+    const_string(const std::string& s) : ptr(s.data()), len(s.size()) {}
+
+    constexpr const char* data() const { return ptr; }
+    constexpr size_t size() const { return len; }
+    constexpr bool empty() const { return len == 0; }
+    constexpr char operator[](size_t i) const { return ptr[i]; }
+    constexpr const char* begin() const { return ptr; }
+    constexpr const char* end() const { return ptr + len; }
+
+    // position of first occurrence of c at or after pos (size() if not found)
+    constexpr size_t find(char c, size_t pos = 0) const {
+        for (size_t i = pos; i < len; i++) {
+            if (ptr[i] == c) { return i; }
+        }
+        return len;
+    }
+
+    constexpr const_string substr(size_t pos, size_t n = size_t(-1)) const {
+        return const_string(ptr + pos, (n < len - pos) ? n : len - pos);
+    }
+
+    std::string str() const { return std::string(ptr, len); }
+};
+
+constexpr bool operator==(const_string a, const_string b) {
+    if (a.size() != b.size()) { return false; }
+    for (size_t i = 0; i < a.size(); i++) {
+        if (a[i] != b[i]) { return false; }
+    }
+    return true;
+}
+
+constexpr bool operator!=(const_string a, const_string b) { return not(a == b); }
+
+//==================================================================================================
+// hashing, usable at compile time
+
+// 64-bit FNV-1a hash
+constexpr uint64_t fnv1a(const_string s, uint64_t hash = 0xcbf29ce484222325ull) {
+    for (size_t i = 0; i < s.size(); i++) {
+        hash = (hash ^ static_cast<unsigned char>(s[i])) * 0x100000001b3ull;
+    }
+    return hash;
+}
+
+namespace helper {
+    // splitmix64 finalizer
+    constexpr uint64_t mix_hash(uint64_t x) {
+        x = (x ^ (x >> 30)) * 0xbf58476d1ce4e5b9ull;
+        x = (x ^ (x >> 27)) * 0x94d049bb133111ebull;
+        return x ^ (x >> 31);
+    }
+}  // namespace helper
@@ -0,0 +1,81 @@
+/*Copyright or © or Copr. CNRS (2019). Contributors:
+- Vincent Lanore. vincent.lanore@gmail.com
+
+This software is a computer program whose purpose is to provide header-only library to create tuple
+indexed by type tags.
+
+This software is governed by the CeCILL-C license under French law and abiding by the rules of
+distribution of free software. You can use, modify and/ or redistribute the software under the terms
+of the CeCILL-C license as circulated by CEA, CNRS and INRIA at the following URL
+"http://www.cecill.info".
+
+As a counterpart to the access to the source code and rights to copy, modify and redistribute
+granted by the license, users are provided only with a limited warranty and the software's author,
+the holder of the economic rights, and the successive licensors have only limited liability.
+
+In this respect, the user's attention is drawn to the risks associated with loading, using,
+modifying and/or developing or reproducing the software by the user in light of its specific status
+of free software, that may mean that it is complicated to manipulate, and that also therefore means
+that it is reserved for developers and experienced professionals having in-depth computer knowledge.
+Users are therefore encouraged to load and test the software's suitability as regards their
+requirements in conditions enabling the security of their systems and/or data to be ensured and,
+more generally, to use and operate it in the same conditions as regards security.
+
+The fact that you are presently reading this means that you have had knowledge of the CeCILL-C
+license and that you accept its terms.*/
+
+#pragma once
+
+#include "shared_field.hpp"
+
+/* Copy-on-write field storage: copies of a tuple share the field's value (one heap block holding
+the value and an atomic reference count). Read-only access (const get) is a single dereference;
+the first mutable access (non-const get) through a copy whose value is shared clones the value,
+so that other copies are unaffected. Suited to large data shared by many replicas of a model and
+rarely modified. A cow_ptr is a shared_value (shared_field.hpp) whose mutable access clones. */
+
+template <class T>
+class cow_ptr : public shared_value<T> {
+    using base = shared_value<T>;
+    using typename base::block;
+    using base::b;
+
+  public:
+    using base::base;
+
+    const T& read() const { return this->get(); }
+
+    // clones the value first if it is shared
+    T& write() {
+        assert(b != nullptr);
+        if (this->use_count() != 1) {
+            block* copy = new block(b->value);
+            block* old = this->release() ? b : nullptr;  // other owners may have let go meanwhile
+            b = copy;
+            delete old;
+        }
+        return b->value;
+    }
+};
+
+template <class T>
+T& deref_if_ptr(cow_ptr<T>& x) {
+    return x.write();
+}
+
+template <class T>
+const T& deref_if_ptr(const cow_ptr<T>& x) {
+    return x.read();
+}
+
+template <class T>
+bool is_null_field(const cow_ptr<T>& x) {
+    return x.use_count() == 0;
+}
+
+// to be used in make_tagged_tuple calls
+template <class Tag, class Type>
+auto cow_field(Type&& data) {
+    using value_type = std::decay_t<Type>;
+    return TagValuePair<Tag, cow_ptr<value_type>>(cow_ptr<value_type>(std::forward<Type>(data)));
+}
@@ -0,0 +1,297 @@
+/*Copyright or © or Copr. CNRS (2019). Contributors:
+- Vincent Lanore. vincent.lanore@gmail.com
+
+This software is a computer program whose purpose is to provide header-only library to create tuple
+indexed by type tags.
+
+This software is governed by the CeCILL-C license under French law and abiding by the rules of
+distribution of free software. You can use, modify and/ or redistribute the software under the terms
+of the CeCILL-C license as circulated by CEA, CNRS and INRIA at the following URL
+"http://www.cecill.info".
+
+As a counterpart to the access to the source code and rights to copy, modify and redistribute
+granted by the license, users are provided only with a limited warranty and the software's author,
+the holder of the economic rights, and the successive licensors have only limited liability.
+
+In this respect, the user's attention is drawn to the risks associated with loading, using,
+modifying and/or developing or reproducing the software by the user in light of its specific status
+of free software, that may mean that it is complicated to manipulate, and that also therefore means
+that it is reserved for developers and experienced professionals having in-depth computer knowledge.
+Users are therefore encouraged to load and test the software's suitability as regards their
+requirements in conditions enabling the security of their systems and/or data to be ensured and,
+more generally, to use and operate it in the same conditions as regards security.
+
+The fact that you are presently reading this means that you have had knowledge of the CeCILL-C
+license and that you accept its terms.*/
+
+#pragma once
+
+#include <algorithm>
+#include <cstdio>
+#include <string>
+#include <thread>
+#include <vector>
+#include "number_io.hpp"
+#include "visit_by_name.hpp"
+
+/* Bulk loading of CSV/TSV tables. Header columns are mapped to fields by tag name (columns without
+a matching field are ignored, fields without a column keep their default value). Numbers are parsed
+with the locale-independent parsers of number_io.hpp. Large inputs can be split at line boundaries
+and parsed by several threads.
+
+Rows are loaded either into a std::vector of tagged tuples or into column storage, i.e., a tagged
+tuple whose fields are std::vectors (one per column). Supported cell types are arithmetic types and
+std::string. Cells may be quoted with '"' (with "" as an escaped quote) but may not contain line
+breaks. */
+
+//==================================================================================================
+// cell parsing
+
+inline bool parse_cell(const char* begin, const char* end, std::string& value) {
+    value.assign(begin, end);
+    return true;
+}
+
+inline bool parse_cell(const char* begin, const char* end, bool& value) {
+    const_string cell(begin, static_cast<size_t>(end - begin));
+    value = cell == "1" or cell == "true";
+    return value or cell == "0" or cell == "false";
+}
+
+namespace helper {
+    template <class T>
+    const char* parse_cell_number(const char* begin, const char* end, T& value, std::true_type) {
+        return parse_integer(begin, end, value);
+    }
+
+    template <class T>
+    const char* parse_cell_number(const char* begin, const char* end, T& value, std::false_type) {
+        return parse_double(begin, end, value);
+    }
+}  // namespace helper
+
+template <class T, class = std::enable_if_t<std::is_arithmetic<T>::value>>
+bool parse_cell(const char* begin, const char* end, T& value) {
+    return helper::parse_cell_number(begin, end, value, std::is_integral<T>()) == end;
+}
+
+//==================================================================================================
+namespace helper {
+    // storage targets: rows (vector of tuples) or columns (tuple of vectors)
+    template <class Target>
+    struct csv_target;
+
+    template <class TTuple>
+    struct csv_target<std::vector<TTuple>> {
+        using schema_t = TTuple;
+
+        static void start_row(std::vector<TTuple>& rows) { rows.emplace_back(); }
+
+        template <size_t I>
+        static bool set(std::vector<TTuple>& rows, const char* begin, const char* end) {
+            return parse_cell(begin, end, get<I>(rows.back().data));
+        }
+
+        static void append(std::vector<TTuple>& rows, std::vector<TTuple>& other) {
+            rows.insert(rows.end(), std::make_move_iterator(other.begin()),
+                        std::make_move_iterator(other.end()));
+        }
+    };
+
+    template <class MD, class... Fields>
+    struct csv_target<tagged_tuple<MD, Fields...>> {
+        using schema_t = tagged_tuple<MD, Fields...>;
+
+        static void start_row(schema_t& columns) {
+            std::initializer_list<int>{(get<first_t<Fields>>(columns).emplace_back(), 0)...};
+        }
+
+        template <size_t I>
+        static bool set(schema_t& columns, const char* begin, const char* end) {
+            return parse_cell(begin, end, get<I>(columns.data).back());
+        }
+
+        static void append(schema_t& columns, schema_t& other) {
+            std::initializer_list<int>{(append_column(get<first_t<Fields>>(columns),
+                                                      get<first_t<Fields>>(other)),
+                                        0)...};
+        }
+
+        template <class T>
+        static void append_column(std::vector<T>& column, std::vector<T>& other) {
+            column.insert(column.end(), std::make_move_iterator(other.begin()),
+                          std::make_move_iterator(other.end()));
+        }
+    };
+
+    template <class Target>
+    class csv_parser {
+        using target_t = csv_target<Target>;
+        using setter_t = bool (*)(Target&, const char*, const char*);
+
+        char separator;
+        std::vector<setter_t> setters;  // per column, nullptr for ignored columns
+        std::string unquoted;           // buffer for quoted cells containing escaped quotes
+
+        template <size_t... Is>
+        static setter_t setter(int index, std::index_sequence<Is...>) {
+            static constexpr setter_t table[sizeof...(Is) + 1] = {&target_t::template set<Is>...,
+                                                                  nullptr};
+            return index < 0 ? nullptr : table[index];
+        }
+
+        // finds the end of the cell starting at begin; handles quoted cells
+        bool parse_cell_at(Target& target, size_t column, const char*& p, const char* end) {
+            setter_t set = column < setters.size() ? setters[column] : nullptr;
+            if (p != end and *p == '"') {
+                unquoted.clear();
+                p++;
+                while (true) {
+                    const char* quote = p;
+                    while (quote != end and *quote != '"') { quote++; }
+                    if (quote == end) { return false; }
+                    unquoted.append(p, quote);
+                    p = quote + 1;
+                    if (p != end and *p == '"') {
+                        unquoted += '"';
+                        p++;
+                    } else {
+                        break;
+                    }
+                }
+                if (p != end and *p != separator) { return false; }
+                return set == nullptr or
+                       set(target, unquoted.data(), unquoted.data() + unquoted.size());
+            }
+            const char* cell_begin = p;
+            while (p != end and *p != separator) { p++; }
+            return set == nullptr or set(target, cell_begin, p);
+        }
+
+      public:
+        csv_parser(const_string header, char separator) : separator(separator) {
+            using schema_t = typename target_t::schema_t;
+            const char* p = header.begin();
+            while (true) {
+                const char* cell_begin = p;
+                while (p != header.end() and *p != separator) { p++; }
+                const_string name(cell_begin, static_cast<size_t>(p - cell_begin));
+                if (name.size() >= 2 and name[0] == '"' and name[name.size() - 1] == '"') {
+                    name = name.substr(1, name.size() - 2);
+                }
+                using indices = std::make_index_sequence<tuple_nb_fields<schema_t>::value>;
+                setters.push_back(setter(field_index_by_name<schema_t>(name), indices()));
+                if (p == header.end()) { break; }
+                p++;
+            }
+        }
+
+        // parses the lines in [begin, end) (end must be at a line boundary)
+        bool parse_lines(Target& target, const char* begin, const char* end) {
+            const char* p = begin;
+            while (p != end) {
+                const char* line_end = p;
+                while (line_end != end and *line_end != '\n') { line_end++; }
+                const char* next = line_end == end ? end : line_end + 1;
+                if (line_end != p and line_end[-1] == '\r') { line_end--; }
+                if (line_end != p) {  // empty lines are skipped
+                    target_t::start_row(target);
+                    for (size_t column = 0;; column++) {
+                        if (not parse_cell_at(target, column, p, line_end)) { return false; }
+                        if (p == line_end) { break; }
+                        p++;  // separator
+                    }
+                }
+                p = next;
+            }
+            return true;
+        }
+    };
+
+    template <class Target>
+    bool load_csv(const_string data, Target& target, char separator, size_t nb_threads) {
+        using target_t = csv_target<Target>;
+        const char* header_end = data.begin() + data.find('\n');
+        const char* body = header_end == data.end() ? header_end : header_end + 1;
+        if (header_end != data.begin() and header_end[-1] == '\r') { header_end--; }
+        csv_parser<Target> parser(
+            const_string(data.begin(), static_cast<size_t>(header_end - data.begin())), separator);
+
+        // splits the body in chunks of roughly equal size, at line boundaries
+        nb_threads = nb_threads == 0 ? 1 : nb_threads;
+        std::vector<const char*> bounds{body};
+        for (size_t i = 1; i < nb_threads; i++) {
+            const char* bound = body + (data.end() - body) * i / nb_threads;
+            bound = std::max(bound, bounds.back());
+            while (bound != data.end() and bound[-1] != '\n') { bound++; }
+            bounds.push_back(bound);
+        }
+        bounds.push_back(data.end());
+
+        // chunks are parsed into temporaries so that target is left unchanged on failure
+        std::vector<Target> chunks(nb_threads);
+        std::vector<csv_parser<Target>> parsers(nb_threads, parser);
+        std::vector<char> ok(nb_threads, true);
+        // threads already started are joined before an exception (thread creation, allocation)
+        // propagates
+        std::vector<std::thread> threads;
+        threads.reserve(nb_threads - 1);
+        try {
+            for (size_t i = 1; i < nb_threads; i++) {
+                threads.emplace_back([&, i]() {
+                    ok[i] = parsers[i].parse_lines(chunks[i], bounds[i], bounds[i + 1]);
+                });
+            }
+            ok[0] = parsers[0].parse_lines(chunks[0], bounds[0], bounds[1]);
+        } catch (...) {
+            for (auto& thread : threads) { thread.join(); }
+            throw;
+        }
+        for (auto& thread : threads) { thread.join(); }
+        for (size_t i = 0; i < nb_threads; i++) {
+            if (not ok[i]) { return false; }
+        }
+        for (auto& chunk : chunks) { target_t::append(target, chunk); }
+        return true;
+    }
+}  // namespace helper
+
+//==================================================================================================
+// entry points; functions return false, leaving the target unchanged, if the input cannot be read
+// or a cell cannot be parsed
+
+// appends the rows of data (header included) to rows
+template <class TTuple>
+bool load_csv(const_string data, std::vector<TTuple>& rows, char separator = ',',
+              size_t nb_threads = 1) {
+    return helper::load_csv(data, rows, separator, nb_threads);
+}
+
+// appends the rows of data (header included) to columns, a tagged tuple of std::vectors
+template <class MD, class... Fields>
+bool load_csv(const_string data, tagged_tuple<MD, Fields...>& columns, char separator = ',',
+              size_t nb_threads = 1) {
+    return helper::load_csv(data, columns, separator, nb_threads);
+}
+
+// reads a whole file in memory with a single read (no iostream)
+inline bool read_file(const char* path, std::string& contents) {
+    std::FILE* file = std::fopen(path, "rb");
+    if (file == nullptr) { return false; }
+    bool ok = std::fseek(file, 0, SEEK_END) == 0;
+    long size = ok ? std::ftell(file) : -1;
+    ok = size >= 0 and std::fseek(file, 0, SEEK_SET) == 0;
+    if (ok) {
+        contents.resize(static_cast<size_t>(size));
+        ok = std::fread(&contents[0], 1, contents.size(), file) == contents.size();
+    }
+    std::fclose(file);
+    return ok;
+}
+
+template <class Target>
+bool load_csv_file(const char* path, Target& target, char separator = ',',
+                   size_t nb_threads = 1) {
+    std::string contents;
+    return read_file(path, contents) and load_csv(contents, target, separator, nb_threads);
+}
@@ -26,106 +26,121 @@ license and that you accept its terms.*/
 
 #pragma once
 
-#ifdef __GNUG__
-#include <cxxabi.h>
-#endif
+#include <memory>
+#include "tag_name.hpp"
 
-#include "tagged_tuple.hpp"
+/* type_to_string<T>() is a human-readable description of a type, e.g.
+"tagged_tuple { int alpha_; unique_ptr<double> beta_; }". The string is built at compile time into
+a static buffer (one per type) from the compiler's own spelling of types, so printing does not
+demangle or allocate. */
 
 //==================================================================================================
-// type id demangling
-
-#ifdef __GNUG__
-static std::string demangle(const char* name) {
-    int status{0};
-    std::unique_ptr<char, void (*)(void*)> res{abi::__cxa_demangle(name, NULL, NULL, &status),
-                                               std::free};
-    return (status == 0) ? res.get() : name;
-}
-#else
-static std::string demangle(const char* name) { return name; }
-#endif
+// fixed-capacity string filled by constexpr code
 
-//==================================================================================================
-// base interface for type-to-string
+template <size_t N>
+struct static_string {
+    char chars[N + 1]{};
+    size_t size{0};
 
-template <class T>
-static std::string type_to_string();
-
-template <class T>
-static std::string type_to_string(T&) {
-    return type_to_string<T>();
-}
-
-//==================================================================================================
-// ttuple printer
-
-namespace helper {
-    template <class T>
-    struct Type {};
-
-    template <class TTuple>
-    std::string ttuple_type_info_helper(std::tuple<>, Type<TTuple>) {
-        return "";
+    constexpr void append(const_string s) {
+        for (size_t i = 0; i < s.size(); i++) { chars[size++] = s[i]; }
     }
 
-    template <class Tag, class Value, class... Rest, class TTuple>
-    std::string ttuple_type_info_helper(std::tuple<utils::Pair<Tag, Value>, Rest...>,
-                                        Type<TTuple>) {
-        std::string type_str = type_to_string<Value>();
-        std::string tag_str = type_to_string<Tag>();
-        std::string other_fields = ttuple_type_info_helper(std::tuple<Rest...>(), Type<TTuple>());
-        return type_str + " " + tag_str + "; " + other_fields;
-    }
-
-    template <class... Pairs>
-    std::string ttuple_type_info_extract_types(Type<tagged_tuple_t<type_map::Map<Pairs...>>>) {
-        using TTuple = tagged_tuple_t<type_map::Map<Pairs...>>;
-        return "tagged_tuple { " +
-               helper::ttuple_type_info_helper(std::tuple<Pairs...>(), helper::Type<TTuple>()) +
-               "}";
-    }
-
-}  // namespace helper
+    constexpr const_string view() const { return const_string(chars, size); }
+};
 
 //==================================================================================================
-// handling references and unique pointers in a pretty way
+// printers: size() is the length of the description, write(out) appends it to out
 
 namespace helper {
     template <class T>
-    std::string pretty_refs_and_pointers(utils::Type<std::unique_ptr<T>>) {
-        return "unique_ptr<" + demangle(typeid(T).name()) + ">";
-    }
+    struct type_printer {
+        static constexpr size_t size() { return type_name<T>().size(); }
+        template <size_t N>
+        static constexpr void write(static_string<N>& out) {
+            out.append(type_name<T>());
+        }
+    };
 
     template <class T>
-    std::string pretty_refs_and_pointers(utils::Type<T&>) {
-        return demangle(typeid(T).name()) + "&";
-    }
+    struct type_printer<T&> {
+        static constexpr size_t size() { return type_printer<T>::size() + 1; }
+        template <size_t N>
+        static constexpr void write(static_string<N>& out) {
+            type_printer<T>::write(out);
+            out.append("&");
+        }
+    };
 
     template <class T>
-    std::string pretty_refs_and_pointers(utils::Type<T>) {
-        return demangle(typeid(T).name());
-    }
-}  // namespace helper
-
-//==================================================================================================
-// selection of type-to-string impl (ttuple or not)
+    struct type_printer<std::unique_ptr<T>> {
+        static constexpr size_t size() { return type_printer<T>::size() + 12; }
+        template <size_t N>
+        static constexpr void write(static_string<N>& out) {
+            out.append("unique_ptr<");
+            type_printer<T>::write(out);
+            out.append(">");
+        }
+    };
+
+    // "<type> <tag>; "
+    template <class Field>
+    struct field_printer {
+        using printer = type_printer<second_t<Field>>;
+        static constexpr size_t size() {
+            return printer::size() + tag_name<first_t<Field>>().size() + 3;
+        }
+        template <size_t N>
+        static constexpr void write(static_string<N>& out) {
+            printer::write(out);
+            out.append(" ");
+            out.append(tag_name<first_t<Field>>());
+            out.append("; ");
+        }
+    };
+
+    template <class MD, class... Fields>
+    struct type_printer<tagged_tuple<MD, Fields...>> {
+        static constexpr size_t size() {
+            size_t result = 16;  // "tagged_tuple { " and "}"
+            size_t sizes[] = {size_t(0), field_printer<Fields>::size()...};
+            for (auto s : sizes) { result += s; }
+            return result;
+        }
+        template <size_t N>
+        static constexpr void write(static_string<N>& out) {
+            out.append("tagged_tuple { ");
+            int dummy[] = {0, (field_printer<Fields>::write(out), 0)...};
+            (void)dummy;
+            out.append("}");
+        }
+    };
 
-namespace helper {
+    template <class T>
+    struct type_string {
+        static constexpr size_t size = type_printer<T>::size();
+        static constexpr static_string<size> make() {
+            static_string<size> result;
+            type_printer<T>::write(result);
+            return result;
+        }
+        static constexpr static_string<size> value = make();
+    };
 
     template <class T>
-    std::string tagged_tuple_selector(std::true_type) {
-        return helper::ttuple_type_info_extract_types(helper::Type<T>());
-    }
+    constexpr size_t type_string<T>::size;
 
     template <class T>
-    std::string tagged_tuple_selector(std::false_type) {
-        return helper::pretty_refs_and_pointers(utils::Type<T>());
-    }
+    constexpr static_string<type_string<T>::size> type_string<T>::value;
 }  // namespace helper
 
+//==================================================================================================
+template <class T>
+constexpr const_string type_to_string() {
+    return helper::type_string<T>::value.view();
+}
+
 template <class T>
-static std::string type_to_string() {
-    constexpr bool is_tuple = is_tagged_tuple<T>;
-    return helper::tagged_tuple_selector<T>(std::integral_constant<bool, is_tuple>());
+constexpr const_string type_to_string(const T&) {
+    return type_to_string<T>();
 }
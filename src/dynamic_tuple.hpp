@@ -0,0 +1,295 @@
+/*Copyright or © or Copr. CNRS (2019). Contributors:
+- Vincent Lanore. vincent.lanore@gmail.com
+
+This software is a computer program whose purpose is to provide header-only library to create tuple
+indexed by type tags.
+
+This software is governed by the CeCILL-C license under French law and abiding by the rules of
+distribution of free software. You can use, modify and/ or redistribute the software under the terms
+of the CeCILL-C license as circulated by CEA, CNRS and INRIA at the following URL
+"http://www.cecill.info".
+
+As a counterpart to the access to the source code and rights to copy, modify and redistribute
+granted by the license, users are provided only with a limited warranty and the software's author,
+the holder of the economic rights, and the successive licensors have only limited liability.
+
+In this respect, the user's attention is drawn to the risks associated with loading, using,
+modifying and/or developing or reproducing the software by the user in light of its specific status
+of free software, that may mean that it is complicated to manipulate, and that also therefore means
+that it is reserved for developers and experienced professionals having in-depth computer knowledge.
+Users are therefore encouraged to load and test the software's suitability as regards their
+requirements in conditions enabling the security of their systems and/or data to be ensured and,
+more generally, to use and operate it in the same conditions as regards security.
+
+The fact that you are presently reading this means that you have had knowledge of the CeCILL-C
+license and that you accept its terms.*/
+
+#pragma once
+
+#include <cassert>
+#include <memory>
+#include <new>
+#include <stdexcept>
+#include <string>
+#include <vector>
+#include "layout.hpp"
+#include "tag_name.hpp"
+
+/* Tagged tuple whose schema (field names, types and offsets) is built at runtime, e.g. by a
+plugin. Fields are laid out like the members of a C struct, in the order they were added to the
+schema, which is also the layout of a static tagged tuple with the standard_layout metadata tag.
+A field is accessed with get<T>(t, tag_id), where tag_id is its index in the schema (see
+dynamic_schema::index_of): one load from a flat offset table, checked against the field's type id
+in debug builds. Static tuples with the same layout can be viewed as dynamic tuples and vice
+versa without copying. Copying a tuple with a field that is not copy-constructible throws
+std::logic_error. A schema must not be modified once tuples use it. */
+
+// exact type identity used by schemas: hash of the compiler spelling of the type (unlike
+// stable_type_hash, which deliberately equates e.g. long and long long, or pooled_ptr and
+// std::unique_ptr, and is only meant for schema compatibility)
+template <class T>
+constexpr uint64_t type_id() {
+    return fnv1a(type_name<T>());
+}
+
+//==================================================================================================
+class dynamic_schema {
+  public:
+    struct field_info {
+        std::string name;
+        uint64_t type_id;
+        size_t size, alignment, offset;
+        void (*construct)(void*);
+        void (*copy)(void*, const void*);
+        void (*destroy)(void*);
+    };
+
+  private:
+    std::vector<field_info> fields;
+    std::vector<size_t> offsets_;
+    size_t size_{0}, alignment_{1};
+
+    template <class T>
+    static void construct_field(void* p) {
+        new (p) T();
+    }
+
+    template <class T>
+    static void copy_field(void* p, const void* other) {
+        new (p) T(*static_cast<const T*>(other));
+    }
+
+    static void copy_not_supported(void*, const void*) {
+        throw std::logic_error("dynamic_tagged_tuple copy of a field that is not copyable");
+    }
+
+    template <class T>
+    static auto copier(std::true_type /* copyable */) {
+        return &copy_field<T>;
+    }
+
+    template <class T>
+    static auto copier(std::false_type /* copyable */) {
+        return &copy_not_supported;
+    }
+
+    template <class T>
+    static void destroy_field(void* p) {
+        static_cast<T*>(p)->~T();
+    }
+
+    template <class TTuple, size_t... Is>
+    void add_fields(std::index_sequence<Is...>) {
+        auto names = field_names<TTuple>();
+        using storage_t = decltype(std::declval<TTuple>().data);
+        std::initializer_list<int>{
+            (add<std::tuple_element_t<Is, storage_t>>(names[Is].str()), 0)...};
+    }
+
+  public:
+    // appends a field of type T after the existing ones
+    template <class T>
+    dynamic_schema& add(std::string name) {
+        static_assert(not std::is_reference<T>::value, "Dynamic tuples cannot hold references");
+        size_t end = fields.empty() ? 0 : fields.back().offset + fields.back().size;
+        size_t offset = (end + alignof(T) - 1) / alignof(T) * alignof(T);
+        fields.push_back({std::move(name), type_id<T>(), sizeof(T), alignof(T), offset,
+                          &construct_field<T>, copier<T>(std::is_copy_constructible<T>()),
+                          &destroy_field<T>});
+        offsets_.push_back(offset);
+        alignment_ = alignof(T) > alignment_ ? alignof(T) : alignment_;
+        size_ = (offset + sizeof(T) + alignment_ - 1) / alignment_ * alignment_;
+        return *this;
+    }
+
+    // schema with the fields of a static tuple (which must have the standard_layout tag)
+    template <class TTuple>
+    static dynamic_schema of() {
+        static_assert(has_standard_layout<TTuple>::value,
+                      "Only standard_layout tuples have a layout matching a dynamic schema");
+        dynamic_schema result;
+        result.add_fields<TTuple>(std::make_index_sequence<tuple_nb_fields<TTuple>::value>());
+        assert(result.size() == sizeof(TTuple));
+        return result;
+    }
+
+    size_t nb_fields() const { return fields.size(); }
+    const field_info& field(size_t tag_id) const { return fields[tag_id]; }
+    const size_t* offsets() const { return offsets_.data(); }
+    size_t size() const { return size_; }
+    size_t alignment() const { return alignment_; }
+
+    // index of the field with this name (-1 if there is none)
+    int index_of(const_string name) const {
+        for (size_t i = 0; i < fields.size(); i++) {
+            if (const_string(fields[i].name) == name) { return int(i); }
+        }
+        return -1;
+    }
+
+    // same fields (names, types, offsets) and size
+    bool compatible_with(const dynamic_schema& other) const {
+        if (size_ != other.size_ or fields.size() != other.fields.size()) { return false; }
+        for (size_t i = 0; i < fields.size(); i++) {
+            auto &a = fields[i], &b = other.fields[i];
+            if (a.name != b.name or a.type_id != b.type_id or a.offset != b.offset) {
+                return false;
+            }
+        }
+        return true;
+    }
+
+    // shared schema of a static tuple type
+    template <class TTuple>
+    static const std::shared_ptr<const dynamic_schema>& shared_of() {
+        static const std::shared_ptr<const dynamic_schema> schema =
+            std::make_shared<const dynamic_schema>(of<TTuple>());
+        return schema;
+    }
+};
+
+//==================================================================================================
+class dynamic_tagged_tuple {
+    std::shared_ptr<const dynamic_schema> schema_;
+    const size_t* offsets;
+    std::unique_ptr<char[]> buffer;  // empty for views
+    char* bytes;
+
+    void allocate() {
+        // (over-allocated by the alignment, since operator new[] ignores it in C++14)
+        size_t alignment = schema_->alignment();
+        buffer.reset(new char[schema_->size() + alignment]);
+        auto address = reinterpret_cast<uintptr_t>(buffer.get());
+        bytes = buffer.get() + (alignment - address % alignment) % alignment;
+    }
+
+    dynamic_tagged_tuple(std::shared_ptr<const dynamic_schema> schema, char* bytes)
+        : schema_(std::move(schema)), offsets(schema_->offsets()), bytes(bytes) {}
+
+    // destroys the first n fields, in reverse order
+    void destroy_fields(size_t n) {
+        for (size_t i = n; i > 0; i--) { schema_->field(i - 1).destroy(bytes + offsets[i - 1]); }
+    }
+
+  public:
+    // owning tuple with value-initialized fields
+    explicit dynamic_tagged_tuple(std::shared_ptr<const dynamic_schema> schema)
+        : schema_(std::move(schema)), offsets(schema_->offsets()) {
+        allocate();
+        size_t i = 0;
+        try {
+            for (; i < schema_->nb_fields(); i++) {
+                schema_->field(i).construct(bytes + offsets[i]);
+            }
+        } catch (...) {
+            destroy_fields(i);
+            throw;
+        }
+    }
+
+    // non-owning view of memory laid out according to schema (e.g. a static tuple)
+    static dynamic_tagged_tuple view(std::shared_ptr<const dynamic_schema> schema, void* data) {
+        return dynamic_tagged_tuple(std::move(schema), static_cast<char*>(data));
+    }
+
+    // copies are owning, even copies of views
+    dynamic_tagged_tuple(const dynamic_tagged_tuple& other)
+        : schema_(other.schema_), offsets(other.offsets) {
+        allocate();
+        size_t i = 0;
+        try {
+            for (; i < schema_->nb_fields(); i++) {
+                schema_->field(i).copy(bytes + offsets[i], other.bytes + offsets[i]);
+            }
+        } catch (...) {
+            destroy_fields(i);
+            throw;
+        }
+    }
+
+    // the moved-from tuple can only be destroyed
+    dynamic_tagged_tuple(dynamic_tagged_tuple&& other) noexcept
+        : schema_(std::move(other.schema_)),
+          offsets(other.offsets),
+          buffer(std::move(other.buffer)),
+          bytes(other.bytes) {
+        other.offsets = nullptr;
+        other.bytes = nullptr;
+    }
+
+    dynamic_tagged_tuple& operator=(const dynamic_tagged_tuple&) = delete;
+    dynamic_tagged_tuple& operator=(dynamic_tagged_tuple&&) = delete;
+
+    ~dynamic_tagged_tuple() {
+        if (buffer != nullptr) { destroy_fields(schema_->nb_fields()); }
+    }
+
+    const dynamic_schema& schema() const { return *schema_; }
+    bool is_view() const { return buffer == nullptr; }
+    void* data() { return bytes; }
+    const void* data() const { return bytes; }
+
+    template <class T>
+    T& get(size_t tag_id) {
+        assert(tag_id < schema_->nb_fields() and schema_->field(tag_id).type_id == type_id<T>());
+        return *reinterpret_cast<T*>(bytes + offsets[tag_id]);
+    }
+
+    template <class T>
+    const T& get(size_t tag_id) const {
+        assert(tag_id < schema_->nb_fields() and schema_->field(tag_id).type_id == type_id<T>());
+        return *reinterpret_cast<const T*>(bytes + offsets[tag_id]);
+    }
+};
+
+template <class T>
+T& get(dynamic_tagged_tuple& t, size_t tag_id) {
+    return t.template get<T>(tag_id);
+}
+
+template <class T>
+const T& get(const dynamic_tagged_tuple& t, size_t tag_id) {
+    return t.template get<T>(tag_id);
+}
+
+//==================================================================================================
+// zero-copy conversions (the viewed object must outlive the view)
+
+// dynamic view of a static standard_layout tuple
+template <class MD, class... Fields>
+dynamic_tagged_tuple dynamic_view(tagged_tuple<MD, Fields...>& t) {
+    return dynamic_tagged_tuple::view(dynamic_schema::shared_of<tagged_tuple<MD, Fields...>>(), &t);
+}
+
+// static view of a dynamic tuple; nullptr if the layouts differ
+template <class TTuple>
+TTuple* static_view(dynamic_tagged_tuple& t) {
+    bool compatible = t.schema().compatible_with(*dynamic_schema::shared_of<TTuple>());
+    return compatible ? reinterpret_cast<TTuple*>(t.data()) : nullptr;
+}
+
+template <class TTuple>
+const TTuple* static_view(const dynamic_tagged_tuple& t) {
+    bool compatible = t.schema().compatible_with(*dynamic_schema::shared_of<TTuple>());
+    return compatible ? reinterpret_cast<const TTuple*>(t.data()) : nullptr;
+}
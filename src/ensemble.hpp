@@ -0,0 +1,262 @@
+/*Copyright or © or Copr. CNRS (2019). Contributors:
+- Vincent Lanore. vincent.lanore@gmail.com
+
+This software is a computer program whose purpose is to provide header-only library to create tuple
+indexed by type tags.
+
+This software is governed by the CeCILL-C license under French law and abiding by the rules of
+distribution of free software. You can use, modify and/ or redistribute the software under the terms
+of the CeCILL-C license as circulated by CEA, CNRS and INRIA at the following URL
+"http://www.cecill.info".
+
+As a counterpart to the access to the source code and rights to copy, modify and redistribute
+granted by the license, users are provided only with a limited warranty and the software's author,
+the holder of the economic rights, and the successive licensors have only limited liability.
+
+In this respect, the user's attention is drawn to the risks associated with loading, using,
+modifying and/or developing or reproducing the software by the user in light of its specific status
+of free software, that may mean that it is complicated to manipulate, and that also therefore means
+that it is reserved for developers and experienced professionals having in-depth computer knowledge.
+Users are therefore encouraged to load and test the software's suitability as regards their
+requirements in conditions enabling the security of their systems and/or data to be ensured and,
+more generally, to use and operate it in the same conditions as regards security.
+
+The fact that you are presently reading this means that you have had knowledge of the CeCILL-C
+license and that you accept its terms.*/
+
+#pragma once
+
+#include <cassert>
+#include <vector>
+#include "tagged_tuple.hpp"
+
+/* An ensemble<TTuple> stores N replicas of a tagged tuple (e.g. the chains of a parallel tempering
+run) in structure-of-arrays form: one std::vector per field, holding the value of that field for
+all replicas, and a nested ensemble per field containing a tagged tuple. Pointer and unique_ptr
+fields are stored by value (their pointees are copied). Cross-replica operations (swapping two
+replicas, per-field means, broadcasting a value) work column by column on contiguous memory. */
+
+template <class TTuple>
+class ensemble;
+
+//==================================================================================================
+namespace helper {
+    template <class T, bool = is_tagged_tuple<T>::value>
+    struct ensemble_column {
+        using type = std::vector<T>;
+    };
+
+    template <class T>
+    struct ensemble_column<T, true> {
+        using type = ensemble<T>;
+    };
+
+    // value stored in the column of a field (pointee for pointer fields)
+    template <class Field>
+    using ensemble_value_t =
+        std::decay_t<decltype(deref_if_ptr(std::declval<second_t<Field>&>()))>;
+
+    template <class Field>
+    using ensemble_column_field_t =
+        field<first_t<Field>, typename ensemble_column<ensemble_value_t<Field>>::type>;
+
+    template <class TTuple>
+    struct ensemble_columns;
+
+    template <class MD, class... Fields>
+    struct ensemble_columns<tagged_tuple<MD, Fields...>> {
+        using type = tagged_tuple<no_metadata, ensemble_column_field_t<Fields>...>;
+    };
+
+    // column operations, for vectors and nested ensembles
+    template <class T>
+    void column_resize(std::vector<T>& column, size_t n) {
+        column.resize(n);
+    }
+
+    template <class T>
+    void column_resize(ensemble<T>& column, size_t n) {
+        column.resize(n);
+    }
+
+    template <class T>
+    void column_fill(std::vector<T>& column, size_t n, const T& value) {
+        column.assign(n, value);
+    }
+
+    template <class T>
+    void column_fill(ensemble<T>& column, size_t n, const T& value) {
+        column.resize(n);
+        column.fill(value);
+    }
+
+    // element type of a column
+    template <class Column>
+    struct column_value;
+
+    template <class T>
+    struct column_value<std::vector<T>> {
+        using type = T;
+    };
+
+    template <class T>
+    struct column_value<ensemble<T>> {
+        using type = T;
+    };
+
+    template <class TTuple, class... Keys>
+    using column_value_t = typename column_value<
+        std::decay_t<decltype(get<Keys...>(std::declval<ensemble<TTuple>&>()))>>::type;
+
+    template <class T>
+    void column_swap(std::vector<T>& column, size_t i, size_t j) {
+        using std::swap;
+        swap(column[i], column[j]);
+    }
+
+    template <class T>
+    void column_swap(ensemble<T>& column, size_t i, size_t j) {
+        column.swap_replicas(i, j);
+    }
+
+    template <class T>
+    void column_extract(const std::vector<T>& column, size_t i, T& out) {
+        out = column[i];
+    }
+
+    template <class T>
+    void column_extract(const ensemble<T>& column, size_t i, T& out) {
+        column.extract(i, out);
+    }
+
+    template <class T>
+    void column_store(std::vector<T>& column, size_t i, const T& value) {
+        column[i] = value;
+    }
+
+    template <class T>
+    void column_store(ensemble<T>& column, size_t i, const T& value) {
+        column.store(i, value);
+    }
+}  // namespace helper
+
+//==================================================================================================
+template <class TTuple>
+class ensemble {
+    static constexpr size_t nb_fields = tuple_nb_fields<TTuple>::value;
+    using indices = std::make_index_sequence<nb_fields>;
+    size_t size_{0};
+
+    template <size_t... Is>
+    void resize(size_t n, std::index_sequence<Is...>) {
+        std::initializer_list<int>{(helper::column_resize(get<Is>(columns.data), n), 0)...};
+    }
+
+    template <size_t... Is>
+    void fill(const TTuple& value, std::index_sequence<Is...>) {
+        std::initializer_list<int>{(
+            helper::column_fill(get<Is>(columns.data), size_, deref_if_ptr(get<Is>(value.data))),
+            0)...};
+    }
+
+    template <size_t... Is>
+    void swap_replicas(size_t i, size_t j, std::index_sequence<Is...>) {
+        std::initializer_list<int>{(helper::column_swap(get<Is>(columns.data), i, j), 0)...};
+    }
+
+    template <size_t... Is>
+    void extract(size_t i, TTuple& out, std::index_sequence<Is...>) const {
+        std::initializer_list<int>{
+            (helper::column_extract(get<Is>(columns.data), i, deref_if_ptr(get<Is>(out.data))),
+             0)...};
+    }
+
+    template <size_t... Is>
+    void store(size_t i, const TTuple& value, std::index_sequence<Is...>) {
+        std::initializer_list<int>{
+            (helper::column_store(get<Is>(columns.data), i, deref_if_ptr(get<Is>(value.data))),
+             0)...};
+    }
+
+  public:
+    using tuple_type = TTuple;
+    typename helper::ensemble_columns<TTuple>::type columns;
+
+    ensemble() = default;
+
+    // n value-initialized replicas
+    explicit ensemble(size_t n) { resize(n); }
+
+    // n copies of prototype
+    ensemble(size_t n, const TTuple& prototype) : size_(n) { fill(prototype); }
+
+    size_t size() const { return size_; }
+
+    void resize(size_t n) {
+        resize(n, indices());
+        size_ = n;
+    }
+
+    // sets all replicas to value
+    void fill(const TTuple& value) { fill(value, indices()); }
+
+    void swap_replicas(size_t i, size_t j) {
+        assert(i < size_ and j < size_);
+        swap_replicas(i, j, indices());
+    }
+
+    // copies replica i into the fields of out
+    void extract(size_t i, TTuple& out) const {
+        assert(i < size_);
+        extract(i, out, indices());
+    }
+
+    // sets replica i to value
+    void store(size_t i, const TTuple& value) {
+        assert(i < size_);
+        store(i, value, indices());
+    }
+};
+
+template <class TTuple>
+constexpr size_t ensemble<TTuple>::nb_fields;
+
+//==================================================================================================
+// column of a field (vector of values, or nested ensemble for tuple fields); the enable_if keeps
+// get<A, B>(t) calls on other types from instantiating ensemble<B>
+
+template <class Key, class TTuple, class = std::enable_if_t<is_tagged_tuple<TTuple>::value>>
+auto& get(ensemble<TTuple>& e) {
+    return get<Key>(e.columns);
+}
+
+template <class Key, class TTuple, class = std::enable_if_t<is_tagged_tuple<TTuple>::value>>
+const auto& get(const ensemble<TTuple>& e) {
+    return get<Key>(e.columns);
+}
+
+template <class FirstKey, class SecondKey, class... Rest, class TTuple>
+auto& get(ensemble<TTuple>& e) {
+    return get<SecondKey, Rest...>(get<FirstKey>(e));
+}
+
+template <class FirstKey, class SecondKey, class... Rest, class TTuple>
+const auto& get(const ensemble<TTuple>& e) {
+    return get<SecondKey, Rest...>(get<FirstKey>(e));
+}
+
+// mean of a numeric field over all replicas
+template <class Key, class... Keys, class TTuple>
+double mean(const ensemble<TTuple>& e) {
+    auto& column = get<Key, Keys...>(e);
+    double sum = 0;
+    for (auto& x : column) { sum += x; }
+    return column.empty() ? 0 : sum / column.size();
+}
+
+// sets a field of all replicas to value, converted to the field type
+template <class Key, class... Keys, class TTuple>
+void broadcast(ensemble<TTuple>& e, const helper::column_value_t<TTuple, Key, Keys...>& value) {
+    auto& column = get<Key, Keys...>(e);
+    helper::column_fill(column, e.size(), value);
+}
@@ -27,6 +27,7 @@ license and that you accept its terms.*/
 #pragma once
 
 #include <string>
+#include "const_string.hpp"
 
 #define TOKEN(name)                                                       \
     struct name {                                                         \
@@ -38,6 +39,7 @@ license and that you accept its terms.*/
         auto& operator()(Model& m) const {                                \
             return get<name>(m);                                          \
         }                                                                 \
-        static std::string to_string() { return #name; }                   \
+        static std::string to_string() { return #name; }                  \
+        static constexpr const_string to_const_string() { return #name; } \
     };                                                                    \
     constexpr auto name##_ = name();
@@ -0,0 +1,136 @@
+/*Copyright or © or Copr. CNRS (2019). Contributors:
+- Vincent Lanore. vincent.lanore@gmail.com
+
+This software is a computer program whose purpose is to provide header-only library to create tuple
+indexed by type tags.
+
+This software is governed by the CeCILL-C license under French law and abiding by the rules of
+distribution of free software. You can use, modify and/ or redistribute the software under the terms
+of the CeCILL-C license as circulated by CEA, CNRS and INRIA at the following URL
+"http://www.cecill.info".
+
+As a counterpart to the access to the source code and rights to copy, modify and redistribute
+granted by the license, users are provided only with a limited warranty and the software's author,
+the holder of the economic rights, and the successive licensors have only limited liability.
+
+In this respect, the user's attention is drawn to the risks associated with loading, using,
+modifying and/or developing or reproducing the software by the user in light of its specific status
+of free software, that may mean that it is complicated to manipulate, and that also therefore means
+that it is reserved for developers and experienced professionals having in-depth computer knowledge.
+Users are therefore encouraged to load and test the software's suitability as regards their
+requirements in conditions enabling the security of their systems and/or data to be ensured and,
+more generally, to use and operate it in the same conditions as regards security.
+
+The fact that you are presently reading this means that you have had knowledge of the CeCILL-C
+license and that you accept its terms.*/
+
+#pragma once
+
+#include <atomic>
+#include <cstring>
+#include <functional>
+#include <vector>
+#include "bitwise_traits.hpp"
+#include "const_string.hpp"
+
+/* Hashing of tagged tuples: std::hash<tagged_tuple<...>> combines the hashes of the fields in field
+order (fields are hashed through field_value_ptr, i.e. pointer-like fields by pointee, and vectors
+element-wise). When the tuple is bitwise comparable (see bitwise_traits.hpp), its storage is hashed
+in one pass with hash_bytes instead. */
+
+//==================================================================================================
+// fast non-cryptographic hash of a byte range (8 bytes per step)
+inline uint64_t hash_bytes(const void* data, size_t size, uint64_t seed = 0) {
+    const unsigned char* p = static_cast<const unsigned char*>(data);
+    uint64_t hash = seed ^ (size * 0x9e3779b97f4a7c15ull);
+    for (; size >= 8; p += 8, size -= 8) {
+        uint64_t chunk;
+        std::memcpy(&chunk, p, 8);
+        hash = (hash ^ helper::mix_hash(chunk)) * 0x9e3779b97f4a7c15ull;
+    }
+    uint64_t tail = 0;
+    std::memcpy(&tail, p, size);
+    return helper::mix_hash(hash ^ tail);
+}
+
+inline size_t hash_combine(size_t seed, size_t hash) {
+    return seed ^ (hash + 0x9e3779b97f4a7c15ull + (seed << 6) + (seed >> 2));
+}
+
+//==================================================================================================
+// per-type hashes used for fields
+
+template <class T>
+size_t hash_value(const T& value);
+
+template <class T>
+size_t hash_value(const std::vector<T>& value);
+
+template <class T>
+size_t hash_value(const std::unique_ptr<T>& value);
+
+template <class T>
+size_t hash_value(T* value);
+
+template <class T>
+size_t hash_value(const std::atomic<T>& value);
+
+template <class T>
+size_t hash_value(const T& value) {
+    return std::hash<T>()(value);
+}
+
+template <class T>
+size_t hash_value(const std::vector<T>& value) {
+    size_t result = value.size();
+    for (auto& element : value) { result = hash_combine(result, hash_value(element)); }
+    return result;
+}
+
+template <class T>
+size_t hash_value(const std::unique_ptr<T>& value) {
+    return value == nullptr ? 0 : hash_value(static_cast<const T&>(*value));
+}
+
+template <class T>
+size_t hash_value(T* value) {
+    return value == nullptr ? 0 : hash_value(static_cast<const T&>(*value));
+}
+
+template <class T>
+size_t hash_value(const std::atomic<T>& value) {
+    return hash_value(value.load(std::memory_order_relaxed));
+}
+
+namespace helper {
+    template <class T>
+    size_t hash_field(const T& field) {
+        auto value = field_value_ptr(field);
+        return value == nullptr ? 0 : hash_value(*value);
+    }
+
+    template <class TTuple, size_t... Is>
+    size_t hash_fields(const TTuple& t, std::false_type /* is bitwise comparable */,
+                       std::index_sequence<Is...>) {
+        size_t result = sizeof...(Is);
+        std::initializer_list<int>{
+            (result = hash_combine(result, hash_field(get<Is>(t.data))), 0)...};
+        return result;
+    }
+
+    template <class TTuple, size_t... Is>
+    size_t hash_fields(const TTuple& t, std::true_type /* is bitwise comparable */,
+                       std::index_sequence<Is...>) {
+        return static_cast<size_t>(hash_bytes(&t.data, sizeof(t.data)));
+    }
+}  // namespace helper
+
+namespace std {
+    template <class MD, class... Fields>
+    struct hash<tagged_tuple<MD, Fields...>> {
+        size_t operator()(const tagged_tuple<MD, Fields...>& t) const {
+            return helper::hash_fields(t, is_bitwise_comparable<tagged_tuple<MD, Fields...>>(),
+                                       std::index_sequence_for<Fields...>());
+        }
+    };
+}  // namespace std
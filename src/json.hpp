@@ -0,0 +1,549 @@
+/*Copyright or © or Copr. CNRS (2019). Contributors:
+- Vincent Lanore. vincent.lanore@gmail.com
+
+This software is a computer program whose purpose is to provide header-only library to create tuple
+indexed by type tags.
+
+This software is governed by the CeCILL-C license under French law and abiding by the rules of
+distribution of free software. You can use, modify and/ or redistribute the software under the terms
+of the CeCILL-C license as circulated by CEA, CNRS and INRIA at the following URL
+"http://www.cecill.info".
+
+As a counterpart to the access to the source code and rights to copy, modify and redistribute
+granted by the license, users are provided only with a limited warranty and the software's author,
+the holder of the economic rights, and the successive licensors have only limited liability.
+
+In this respect, the user's attention is drawn to the risks associated with loading, using,
+modifying and/or developing or reproducing the software by the user in light of its specific status
+of free software, that may mean that it is complicated to manipulate, and that also therefore means
+that it is reserved for developers and experienced professionals having in-depth computer knowledge.
+Users are therefore encouraged to load and test the software's suitability as regards their
+requirements in conditions enabling the security of their systems and/or data to be ensured and,
+more generally, to use and operate it in the same conditions as regards security.
+
+The fact that you are presently reading this means that you have had knowledge of the CeCILL-C
+license and that you accept its terms.*/
+
+#pragma once
+
+#include <atomic>
+#include <string>
+#include <vector>
+#include "number_io.hpp"
+#include "visit_by_name.hpp"
+
+/* JSON encoding and decoding of tagged tuples, driven by the tag names. Supported field types are
+nested tagged tuples, arithmetic types, std::string, std::vector of supported types, and
+unique/raw pointers to supported types (null pointers are written as null). Fields are accessed
+through field_value_ptr, so pooled, shared, copy-on-write, concurrent and cache-line isolated
+fields are encoded as their values. Object keys are escaped at compile time and decoding looks
+keys up through the compile-time name table, without building an intermediate document. */
+
+//==================================================================================================
+// compile-time escaped keys
+
+namespace helper {
+    constexpr size_t json_escaped_size(const_string s) {
+        size_t size = 0;
+        for (size_t i = 0; i < s.size(); i++) {
+            char c = s[i];
+            size += (c == '"' or c == '\\') ? 2 : (static_cast<unsigned char>(c) < 0x20) ? 6 : 1;
+        }
+        return size;
+    }
+
+    template <size_t N>
+    struct char_buffer {
+        char data[N + 1]{};
+    };
+
+    // "name": with name escaped
+    template <class Tag>
+    struct json_key {
+        static constexpr size_t size = json_escaped_size(tag_name<Tag>()) + 3;
+
+        static constexpr char_buffer<size> make() {
+            constexpr const_string name = tag_name<Tag>();
+            char_buffer<size> result{};
+            const char hex[] = "0123456789abcdef";
+            size_t pos = 0;
+            result.data[pos++] = '"';
+            for (size_t i = 0; i < name.size(); i++) {
+                unsigned char c = static_cast<unsigned char>(name[i]);
+                if (c == '"' or c == '\\') {
+                    result.data[pos++] = '\\';
+                    result.data[pos++] = static_cast<char>(c);
+                } else if (c < 0x20) {
+                    result.data[pos++] = '\\';
+                    result.data[pos++] = 'u';
+                    result.data[pos++] = '0';
+                    result.data[pos++] = '0';
+                    result.data[pos++] = hex[c >> 4];
+                    result.data[pos++] = hex[c & 0xf];
+                } else {
+                    result.data[pos++] = static_cast<char>(c);
+                }
+            }
+            result.data[pos++] = '"';
+            result.data[pos++] = ':';
+            return result;
+        }
+
+        static constexpr char_buffer<size> value = make();
+    };
+
+    template <class Tag>
+    constexpr char_buffer<json_key<Tag>::size> json_key<Tag>::value;
+}  // namespace helper
+
+//==================================================================================================
+// encoding
+
+inline void write_json(std::string& out, bool value) { out += value ? "true" : "false"; }
+
+namespace helper {
+    template <class T>
+    char* write_json_number(char* out, T value, std::true_type /* is integral */) {
+        return write_integer(out, value);
+    }
+
+    template <class T>
+    char* write_json_number(char* out, T value, std::false_type /* is integral */) {
+        return write_double(out, static_cast<double>(value));
+    }
+}  // namespace helper
+
+template <class T, class = std::enable_if_t<std::is_arithmetic<T>::value>>
+void write_json(std::string& out, T value) {
+    if (not std::isfinite(static_cast<double>(value))) {
+        out += "null";  // JSON has no representation for nan and infinities
+        return;
+    }
+    char buffer[number_io_max_chars];
+    char* end = helper::write_json_number(buffer, value, std::is_integral<T>());
+    out.append(buffer, end);
+}
+
+inline void write_json(std::string& out, const std::string& value) {
+    static const char hex[] = "0123456789abcdef";
+    out += '"';
+    size_t chunk_start = 0;  // unescaped characters are appended in chunks
+    for (size_t i = 0; i < value.size(); i++) {
+        unsigned char c = static_cast<unsigned char>(value[i]);
+        if (c == '"' or c == '\\' or c < 0x20) {
+            out.append(value, chunk_start, i - chunk_start);
+            chunk_start = i + 1;
+            out += '\\';
+            switch (c) {
+                case '"': out += '"'; break;
+                case '\\': out += '\\'; break;
+                case '\n': out += 'n'; break;
+                case '\t': out += 't'; break;
+                case '\r': out += 'r'; break;
+                default:
+                    out += "u00";
+                    out += hex[c >> 4];
+                    out += hex[c & 0xf];
+            }
+        }
+    }
+    out.append(value, chunk_start, std::string::npos);
+    out += '"';
+}
+
+// concurrent fields
+template <class T>
+void write_json(std::string& out, const std::atomic<T>& value) {
+    write_json(out, value.load(std::memory_order_relaxed));
+}
+
+template <class T>
+void write_json(std::string& out, const std::vector<T>& value);
+
+template <class T>
+void write_json(std::string& out, const std::unique_ptr<T>& value);
+
+template <class T>
+void write_json(std::string& out, T* value);
+
+template <class MD, class... Fields>
+void write_json(std::string& out, const tagged_tuple<MD, Fields...>& t);
+
+template <class T>
+void write_json(std::string& out, const std::vector<T>& value) {
+    out += '[';
+    for (size_t i = 0; i < value.size(); i++) {
+        if (i != 0) { out += ','; }
+        write_json(out, static_cast<const T&>(value[i]));
+    }
+    out += ']';
+}
+
+template <class T>
+void write_json(std::string& out, const std::unique_ptr<T>& value) {
+    if (value == nullptr) {
+        out += "null";
+    } else {
+        write_json(out, static_cast<const T&>(*value));
+    }
+}
+
+template <class T>
+void write_json(std::string& out, T* value) {
+    if (value == nullptr) {
+        out += "null";
+    } else {
+        write_json(out, static_cast<const T&>(*value));
+    }
+}
+
+namespace helper {
+    template <class Tag, class T>
+    void write_json_field(std::string& out, const T& field, bool first) {
+        if (not first) { out += ','; }
+        out.append(json_key<Tag>::value.data, json_key<Tag>::size);
+        auto value = field_value_ptr(field);
+        if (value == nullptr) {
+            out += "null";
+        } else {
+            write_json(out, *value);
+        }
+    }
+
+    template <class MD, class... Fields, size_t... Is>
+    void write_json_fields(std::string& out, const tagged_tuple<MD, Fields...>& t,
+                           std::index_sequence<Is...>) {
+        std::initializer_list<int>{
+            (write_json_field<first_t<Fields>>(out, get<Is>(t.data), Is == 0), 0)...};
+    }
+}  // namespace helper
+
+template <class MD, class... Fields>
+void write_json(std::string& out, const tagged_tuple<MD, Fields...>& t) {
+    out += '{';
+    helper::write_json_fields(out, t, std::index_sequence_for<Fields...>());
+    out += '}';
+}
+
+template <class T>
+std::string to_json(const T& value) {
+    std::string result;
+    write_json(result, value);
+    return result;
+}
+
+//==================================================================================================
+// decoding
+
+class json_reader {
+    const char* cur;
+    const char* end;
+    std::string scratch;  // for keys containing escape sequences
+
+    static void append_utf8(std::string& out, uint32_t code_point) {
+        if (code_point < 0x80) {
+            out += static_cast<char>(code_point);
+        } else if (code_point < 0x800) {
+            out += static_cast<char>(0xc0 | (code_point >> 6));
+            out += static_cast<char>(0x80 | (code_point & 0x3f));
+        } else if (code_point < 0x10000) {
+            out += static_cast<char>(0xe0 | (code_point >> 12));
+            out += static_cast<char>(0x80 | ((code_point >> 6) & 0x3f));
+            out += static_cast<char>(0x80 | (code_point & 0x3f));
+        } else {
+            out += static_cast<char>(0xf0 | (code_point >> 18));
+            out += static_cast<char>(0x80 | ((code_point >> 12) & 0x3f));
+            out += static_cast<char>(0x80 | ((code_point >> 6) & 0x3f));
+            out += static_cast<char>(0x80 | (code_point & 0x3f));
+        }
+    }
+
+    bool parse_hex4(uint32_t& value) {
+        if (end - cur < 4) { return false; }
+        value = 0;
+        for (int i = 0; i < 4; i++) {
+            char c = *cur++;
+            uint32_t digit = (c >= '0' and c <= '9')   ? uint32_t(c - '0')
+                             : (c >= 'a' and c <= 'f') ? uint32_t(c - 'a' + 10)
+                             : (c >= 'A' and c <= 'F') ? uint32_t(c - 'A' + 10)
+                                                       : 16;
+            if (digit == 16) { return false; }
+            value = value * 16 + digit;
+        }
+        return true;
+    }
+
+    // decodes the rest of a string whose opening quote and unescaped prefix have been consumed
+    bool parse_escaped_string(std::string& out) {
+        while (cur != end and *cur != '"') {
+            if (*cur != '\\') {
+                out += *cur++;
+                continue;
+            }
+            if (++cur == end) { return false; }
+            char c = *cur++;
+            switch (c) {
+                case '"': out += '"'; break;
+                case '\\': out += '\\'; break;
+                case '/': out += '/'; break;
+                case 'b': out += '\b'; break;
+                case 'f': out += '\f'; break;
+                case 'n': out += '\n'; break;
+                case 'r': out += '\r'; break;
+                case 't': out += '\t'; break;
+                case 'u': {
+                    uint32_t code_point;
+                    if (not parse_hex4(code_point)) { return false; }
+                    if (code_point >= 0xd800 and code_point < 0xdc00) {  // surrogate pair
+                        uint32_t low;
+                        if (end - cur < 2 or cur[0] != '\\' or cur[1] != 'u') { return false; }
+                        cur += 2;
+                        if (not parse_hex4(low) or low < 0xdc00 or low >= 0xe000) { return false; }
+                        code_point = 0x10000 + ((code_point - 0xd800) << 10) + (low - 0xdc00);
+                    }
+                    append_utf8(out, code_point);
+                    break;
+                }
+                default: return false;
+            }
+        }
+        return consume('"');
+    }
+
+  public:
+    explicit json_reader(const_string json) : cur(json.begin()), end(json.end()) {}
+
+    void skip_whitespace() {
+        while (cur != end and (*cur == ' ' or *cur == '\n' or *cur == '\t' or *cur == '\r')) {
+            cur++;
+        }
+    }
+
+    bool at_end() {
+        skip_whitespace();
+        return cur == end;
+    }
+
+    char peek() {
+        skip_whitespace();
+        return cur == end ? '\0' : *cur;
+    }
+
+    bool consume(char c) {
+        if (peek() != c) { return false; }
+        cur++;
+        return true;
+    }
+
+    bool consume_literal(const_string literal) {
+        skip_whitespace();
+        if (static_cast<size_t>(end - cur) < literal.size() or
+            const_string(cur, literal.size()) != literal) {
+            return false;
+        }
+        cur += literal.size();
+        return true;
+    }
+
+    bool parse_bool(bool& value) {
+        if (consume_literal("true")) {
+            value = true;
+        } else if (consume_literal("false")) {
+            value = false;
+        } else {
+            return false;
+        }
+        return true;
+    }
+
+    template <class T>
+    bool parse_number(T& value, std::true_type /* is integral */) {
+        skip_whitespace();
+        const char* p = parse_integer(cur, end, value);
+        cur = p == nullptr ? cur : p;
+        return p != nullptr;
+    }
+
+    template <class T>
+    bool parse_number(T& value, std::false_type /* is integral */) {
+        if (consume_literal("null")) {
+            value = std::numeric_limits<T>::quiet_NaN();
+            return true;
+        }
+        skip_whitespace();
+        const char* p = parse_double(cur, end, value);
+        cur = p == nullptr ? cur : p;
+        return p != nullptr;
+    }
+
+    bool parse_string(std::string& value) {
+        if (not consume('"')) { return false; }
+        const char* start = cur;
+        while (cur != end and *cur != '"' and *cur != '\\') { cur++; }
+        value.assign(start, cur);
+        return parse_escaped_string(value);
+    }
+
+    // object key (including the ':' that follows); points into the input when not escaped
+    bool parse_key(const_string& key) {
+        if (not consume('"')) { return false; }
+        const char* start = cur;
+        while (cur != end and *cur != '"' and *cur != '\\') { cur++; }
+        if (cur != end and *cur == '"') {
+            key = const_string(start, static_cast<size_t>(cur - start));
+            cur++;
+        } else {
+            scratch.assign(start, cur);
+            if (not parse_escaped_string(scratch)) { return false; }
+            key = scratch;
+        }
+        return consume(':');
+    }
+
+    // deeper arrays and objects in skipped values are rejected (bounds the recursion)
+    static constexpr size_t max_skip_depth = 256;
+
+    // skips any value (used for unknown keys)
+    bool skip_value(size_t depth = 0) {
+        switch (peek()) {
+            case '"': {
+                cur++;
+                while (cur != end and *cur != '"') {
+                    if (*cur == '\\' and ++cur == end) { return false; }
+                    cur++;
+                }
+                return consume('"');
+            }
+            case '{':
+            case '[': {
+                if (depth == max_skip_depth) { return false; }
+                char close = *cur == '{' ? '}' : ']';
+                cur++;
+                if (consume(close)) { return true; }
+                do {
+                    const_string key;
+                    if (close == '}' and not parse_key(key)) { return false; }
+                    if (not skip_value(depth + 1)) { return false; }
+                } while (consume(','));
+                return consume(close);
+            }
+            case 't': return consume_literal("true");
+            case 'f': return consume_literal("false");
+            case 'n': return consume_literal("null");
+            default: {
+                double ignored;
+                const char* p = parse_double(cur, end, ignored);
+                cur = p == nullptr ? cur : p;
+                return p != nullptr;
+            }
+        }
+    }
+};
+
+inline bool read_json(json_reader& reader, bool& value) { return reader.parse_bool(value); }
+
+template <class T, class = std::enable_if_t<std::is_arithmetic<T>::value>>
+bool read_json(json_reader& reader, T& value) {
+    return reader.parse_number(value, std::is_integral<T>());
+}
+
+inline bool read_json(json_reader& reader, std::string& value) {
+    return reader.parse_string(value);
+}
+
+template <class T>
+bool read_json(json_reader& reader, std::atomic<T>& value) {
+    T result;
+    if (not read_json(reader, result)) { return false; }
+    value.store(result, std::memory_order_relaxed);
+    return true;
+}
+
+template <class T>
+bool read_json(json_reader& reader, std::vector<T>& value);
+
+template <class T>
+bool read_json(json_reader& reader, std::unique_ptr<T>& value);
+
+template <class T>
+bool read_json(json_reader& reader, T*& value);
+
+template <class MD, class... Fields>
+bool read_json(json_reader& reader, tagged_tuple<MD, Fields...>& t);
+
+template <class T>
+bool read_json(json_reader& reader, std::vector<T>& value) {
+    if (not reader.consume('[')) { return false; }
+    value.clear();
+    if (reader.consume(']')) { return true; }
+    do {
+        T element{};  // (value.back() would be a proxy for std::vector<bool>)
+        if (not read_json(reader, element)) { return false; }
+        value.push_back(std::move(element));
+    } while (reader.consume(','));
+    return reader.consume(']');
+}
+
+template <class T>
+bool read_json(json_reader& reader, std::unique_ptr<T>& value) {
+    if (reader.consume_literal("null")) {
+        value.reset();
+        return true;
+    }
+    if (value == nullptr) { value = std::make_unique<T>(); }
+    return read_json(reader, *value);
+}
+
+// raw pointers are not owned: values are read into the existing pointee
+template <class T>
+bool read_json(json_reader& reader, T*& value) {
+    if (value == nullptr) { return reader.consume_literal("null"); }
+    return read_json(reader, *value);
+}
+
+namespace helper {
+    template <size_t I, class TTuple>
+    bool read_json_field(json_reader& reader, TTuple& t) {
+        auto& field = get<I>(t.data);
+        using field_t = std::remove_reference_t<decltype(field)>;
+        if (is_nullable_field<field_t>::value and reader.consume_literal("null")) {
+            return reset_field(field);
+        }
+        auto value = emplace_field_value(field);
+        return value != nullptr and read_json(reader, *value);
+    }
+
+    template <class TTuple, size_t... Is>
+    bool read_json_field(json_reader& reader, TTuple& t, int index, std::index_sequence<Is...>) {
+        using fun_t = bool (*)(json_reader&, TTuple&);
+        static constexpr fun_t table[sizeof...(Is) + 1] = {&read_json_field<Is, TTuple>...,
+                                                           nullptr};
+        return table[index](reader, t);
+    }
+}  // namespace helper
+
+// fields absent from the input are left untouched and unknown keys are skipped
+template <class MD, class... Fields>
+bool read_json(json_reader& reader, tagged_tuple<MD, Fields...>& t) {
+    using tuple_t = tagged_tuple<MD, Fields...>;
+    if (not reader.consume('{')) { return false; }
+    if (reader.consume('}')) { return true; }
+    do {
+        const_string key;
+        if (not reader.parse_key(key)) { return false; }
+        int index = field_index_by_name<tuple_t>(key);
+        bool ok = index < 0 ? reader.skip_value()
+                            : helper::read_json_field(reader, t, index,
+                                                      std::index_sequence_for<Fields...>());
+        if (not ok) { return false; }
+    } while (reader.consume(','));
+    return reader.consume('}');
+}
+
+// returns false if json is malformed or does not match the type of value (which may then be
+// partially updated)
+template <class T>
+bool from_json(T& value, const_string json) {
+    json_reader reader(json);
+    return read_json(reader, value) and reader.at_end();
+}
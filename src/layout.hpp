@@ -0,0 +1,66 @@
+/*Copyright or © or Copr. CNRS (2019). Contributors:
+- Vincent Lanore. vincent.lanore@gmail.com
+
+This software is a computer program whose purpose is to provide header-only library to create tuple
+indexed by type tags.
+
+This software is governed by the CeCILL-C license under French law and abiding by the rules of
+distribution of free software. You can use, modify and/ or redistribute the software under the terms
+of the CeCILL-C license as circulated by CEA, CNRS and INRIA at the following URL
+"http://www.cecill.info".
+
+As a counterpart to the access to the source code and rights to copy, modify and redistribute
+granted by the license, users are provided only with a limited warranty and the software's author,
+the holder of the economic rights, and the successive licensors have only limited liability.
+
+In this respect, the user's attention is drawn to the risks associated with loading, using,
+modifying and/or developing or reproducing the software by the user in light of its specific status
+of free software, that may mean that it is complicated to manipulate, and that also therefore means
+that it is reserved for developers and experienced professionals having in-depth computer knowledge.
+Users are therefore encouraged to load and test the software's suitability as regards their
+requirements in conditions enabling the security of their systems and/or data to be ensured and,
+more generally, to use and operate it in the same conditions as regards security.
+
+The fact that you are presently reading this means that you have had knowledge of the CeCILL-C
+license and that you accept its terms.*/
+
+#pragma once
+
+#include <array>
+#include "tagged_tuple.hpp"
+
+/* Compile-time layout of tagged tuples with the standard_layout metadata tag, e.g.
+metadata<type_list<standard_layout>, type_map<>>. Such tuples are standard-layout types whose
+fields are laid out like the members of the equivalent C struct (reference fields as pointers), so
+offsets can be used for scatter/gather, zero-copy I/O or foreign-language bindings. Offsets are in
+bytes from the start of the tuple. */
+
+template <class TTuple>
+using has_standard_layout = helper::uses_struct_storage<metadata_t<TTuple>>;
+
+//==================================================================================================
+namespace helper {
+    template <class TTuple>
+    struct tuple_layout {
+        static_assert(has_standard_layout<TTuple>::value,
+                      "Compile-time layout requires the standard_layout metadata tag");
+        using type = typename decltype(std::declval<TTuple>().data)::layout;
+    };
+}  // namespace helper
+
+template <class TTuple>
+constexpr std::array<size_t, tuple_nb_fields<TTuple>::value> field_offsets() {
+    return helper::tuple_layout<TTuple>::type::offsets();
+}
+
+// sizes of the stored fields (pointer size for reference fields)
+template <class TTuple>
+constexpr std::array<size_t, tuple_nb_fields<TTuple>::value> field_sizes() {
+    return helper::tuple_layout<TTuple>::type::sizes();
+}
+
+template <class Key, class TTuple>
+constexpr size_t offset_of() {
+    return helper::tuple_layout<TTuple>::type::offset(
+        map_element_index<Key, field_map_t<TTuple>>::value);
+}
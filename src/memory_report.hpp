@@ -0,0 +1,286 @@
+/*Copyright or © or Copr. CNRS (2019). Contributors:
+- Vincent Lanore. vincent.lanore@gmail.com
+
+This software is a computer program whose purpose is to provide header-only library to create tuple
+indexed by type tags.
+
+This software is governed by the CeCILL-C license under French law and abiding by the rules of
+distribution of free software. You can use, modify and/ or redistribute the software under the terms
+of the CeCILL-C license as circulated by CEA, CNRS and INRIA at the following URL
+"http://www.cecill.info".
+
+As a counterpart to the access to the source code and rights to copy, modify and redistribute
+granted by the license, users are provided only with a limited warranty and the software's author,
+the holder of the economic rights, and the successive licensors have only limited liability.
+
+In this respect, the user's attention is drawn to the risks associated with loading, using,
+modifying and/or developing or reproducing the software by the user in light of its specific status
+of free software, that may mean that it is complicated to manipulate, and that also therefore means
+that it is reserved for developers and experienced professionals having in-depth computer knowledge.
+Users are therefore encouraged to load and test the software's suitability as regards their
+requirements in conditions enabling the security of their systems and/or data to be ensured and,
+more generally, to use and operate it in the same conditions as regards security.
+
+The fact that you are presently reading this means that you have had knowledge of the CeCILL-C
+license and that you accept its terms.*/
+
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <cassert>
+#include <memory>
+#include <string>
+#include <vector>
+#include "tag_name.hpp"
+
+/* Memory footprint of a tagged tuple broken down by field: inline size, alignment, padding after
+the field, and heap memory owned by the field (through unique_ptr, pooled, shared and copy-on-write
+fields, std::vector and std::string, recursively). Shared values are reported by every tuple that
+shares them. Nested tagged tuples, held directly or through a pointer-like field, are reported field
+by field after their parent field, with dotted paths. Reference fields own nothing. Other
+heap-owning types can be covered by specializing heap_size. */
+
+template <class T>
+class object_pool;  // pool.hpp
+
+template <class T, class Count>
+class counted_ptr;  // shared_field.hpp
+
+template <class T>
+class cow_ptr;  // cow.hpp
+
+namespace helper {
+    template <class T, class Count>
+    struct counted_block;  // shared_field.hpp
+}  // namespace helper
+
+struct field_memory {
+    std::string path;   // e.g. "beta_.alpha_" for field alpha_ of nested tuple beta_
+    size_t depth;       // 0 for fields of the top-level tuple
+    size_t count;       // number of tuples covered by this entry
+    size_t size;        // inline bytes (sizeof of the stored field, times count)
+    size_t alignment;   // alignof of the stored field
+    size_t padding;     // bytes between the field and the next one in memory (times count)
+    size_t heap_bytes;  // heap bytes owned by the field, recursively
+};
+
+//==================================================================================================
+// heap memory owned by an object (0 unless specialized)
+
+template <class T, class = void>
+struct heap_size {
+    static size_t of(const T&) { return 0; }
+};
+
+template <class T>
+size_t heap_bytes(const T& x) {
+    return heap_size<T>::of(x);
+}
+
+template <class T>
+struct heap_size<std::unique_ptr<T>> {
+    static size_t of(const std::unique_ptr<T>& p) {
+        return p == nullptr ? 0 : sizeof(T) + heap_bytes(*p);
+    }
+};
+
+template <class T, class Allocator>
+struct heap_size<std::vector<T, Allocator>> {
+    static size_t of(const std::vector<T, Allocator>& v) {
+        size_t result = v.capacity() * sizeof(T);
+        for (auto& element : v) { result += heap_bytes(element); }
+        return result;
+    }
+};
+
+template <class Char, class Traits, class Allocator>
+struct heap_size<std::basic_string<Char, Traits, Allocator>> {
+    static size_t of(const std::basic_string<Char, Traits, Allocator>& s) {
+        // short strings are stored inside the string object
+        auto begin = reinterpret_cast<const char*>(&s);
+        auto data = reinterpret_cast<const char*>(s.data());
+        bool inline_buffer = data >= begin and data < begin + sizeof(s);
+        return inline_buffer ? 0 : (s.capacity() + 1) * sizeof(Char);
+    }
+};
+
+// pool blocks hold a T or a free list link
+template <class T>
+struct heap_size<pooled_ptr<T>> {
+    static size_t of(const pooled_ptr<T>& p) {
+        return p.get() == nullptr ? 0 : std::max(sizeof(T), sizeof(void*)) + heap_bytes(*p);
+    }
+};
+
+template <class T, class Count>
+struct heap_size<counted_ptr<T, Count>> {
+    static size_t of(const counted_ptr<T, Count>& p) {
+        return p.use_count() == 0 ? 0
+                                  : sizeof(helper::counted_block<T, Count>) + heap_bytes(p.get());
+    }
+};
+
+template <class T>
+struct heap_size<cow_ptr<T>> : heap_size<counted_ptr<T, std::atomic<size_t>>> {};
+
+template <class T>
+struct heap_size<isolated_value<T>> {
+    static size_t of(const isolated_value<T>& x) { return heap_bytes(x.value); }
+};
+
+template <class MD, class... Fields>
+struct heap_size<tagged_tuple<MD, Fields...>> {
+    template <size_t... Is>
+    static size_t of(const tagged_tuple<MD, Fields...>& t, std::index_sequence<Is...>) {
+        size_t result = 0;
+        using storage_t = decltype(t.data);
+        std::initializer_list<int>{
+            (result += std::is_reference<std::tuple_element_t<Is, storage_t>>::value
+                           ? 0
+                           : heap_bytes(get<Is>(t.data)),
+             0)...};
+        return result;
+    }
+    static size_t of(const tagged_tuple<MD, Fields...>& t) {
+        return of(t, std::index_sequence_for<Fields...>());
+    }
+};
+
+//==================================================================================================
+namespace helper {
+    // stand-in with the size and alignment of a stored field (references are stored as pointers)
+    template <class T>
+    using memory_slot_t = std::conditional_t<std::is_reference<T>::value, void*, T>;
+
+    template <class T>
+    using memory_mirror_slot_t =
+        std::aligned_storage_t<sizeof(memory_slot_t<T>), alignof(memory_slot_t<T>)>;
+
+    // same kind of storage (std::tuple or struct_storage) holding the stand-ins
+    template <class Storage>
+    struct memory_mirror;
+
+    template <class... Ts>
+    struct memory_mirror<std::tuple<Ts...>> {
+        using type = std::tuple<memory_mirror_slot_t<Ts>...>;
+    };
+
+    template <class... Ts>
+    struct memory_mirror<struct_storage<Ts...>> {
+        using type = struct_storage<memory_mirror_slot_t<Ts>...>;
+    };
+
+    // padding after each field, computed on a tuple of trivial stand-ins with the same layout
+    template <class Storage, size_t... Is>
+    std::array<size_t, sizeof...(Is)> field_paddings(std::index_sequence<Is...>) {
+        constexpr size_t n = sizeof...(Is);
+        typename memory_mirror<Storage>::type mirror;
+        auto base = reinterpret_cast<const char*>(&mirror);
+        std::array<size_t, n> begins{{size_t(reinterpret_cast<const char*>(&get<Is>(mirror)) -
+                                             base)...}};
+        std::array<size_t, n> ends{{begins[Is] + sizeof(get<Is>(mirror))...}};
+        std::array<size_t, n> result{};
+        for (size_t i = 0; i < n; i++) {
+            size_t next = sizeof(mirror);
+            for (size_t j = 0; j < n; j++) {
+                if (begins[j] >= ends[i] and begins[j] < next) { next = begins[j]; }
+            }
+            result[i] = next - ends[i];
+        }
+        return result;
+    }
+
+    template <class TTuple>
+    void add_memory_report(const TTuple& t, const std::string& prefix, size_t depth,
+                           std::vector<field_memory>& report, size_t& position);
+
+    template <class T>
+    void add_nested_memory_report(const T&, const std::string&, size_t, std::vector<field_memory>&,
+                                  size_t&) {}
+
+    template <class MD, class... Fields>
+    void add_nested_memory_report(const tagged_tuple<MD, Fields...>& t, const std::string& prefix,
+                                  size_t depth, std::vector<field_memory>& report,
+                                  size_t& position) {
+        add_memory_report(t, prefix, depth, report, position);
+    }
+
+    template <class TTuple, size_t I>
+    void add_field_memory(const TTuple& t, const std::string& prefix, size_t depth,
+                          size_t padding, std::vector<field_memory>& report, size_t& position) {
+        using stored_t = std::tuple_element_t<I, decltype(t.data)>;
+        constexpr bool is_ref = std::is_reference<stored_t>::value;
+        std::string path = prefix + field_names<TTuple>()[I].str();
+        size_t heap = is_ref ? 0 : heap_bytes(get<I>(t.data));
+        if (position == report.size() or report[position].path != path) {
+            report.insert(report.begin() + position,
+                          {path, depth, 0, 0, alignof(memory_slot_t<stored_t>), 0, 0});
+        }
+        auto& entry = report[position++];
+        assert(entry.path == path);
+        entry.count++;
+        entry.size += sizeof(memory_slot_t<stored_t>);
+        entry.padding += padding;
+        entry.heap_bytes += heap;
+        auto value = is_ref ? nullptr : field_value_ptr(get<I>(t.data));
+        if (value != nullptr) {
+            add_nested_memory_report(*value, path + ".", depth + 1, report, position);
+        }
+        // entries of a nested tuple behind a null pointer (reported by other tuples)
+        std::string nested_prefix = path + ".";
+        while (position < report.size() and
+               report[position].path.compare(0, nested_prefix.size(), nested_prefix) == 0) {
+            position++;
+        }
+    }
+
+    template <class TTuple, size_t... Is>
+    void add_memory_report(const TTuple& t, const std::string& prefix, size_t depth,
+                           std::vector<field_memory>& report, size_t& position,
+                           std::index_sequence<Is...> is) {
+        auto paddings = field_paddings<std::decay_t<decltype(t.data)>>(is);
+        std::initializer_list<int>{
+            (add_field_memory<TTuple, Is>(t, prefix, depth, paddings[Is], report, position),
+             0)...};
+    }
+
+    template <class TTuple>
+    void add_memory_report(const TTuple& t, const std::string& prefix, size_t depth,
+                           std::vector<field_memory>& report, size_t& position) {
+        add_memory_report(t, prefix, depth, report, position,
+                          std::make_index_sequence<tuple_nb_fields<TTuple>::value>());
+    }
+}  // namespace helper
+
+//==================================================================================================
+// per field, in field order, each field followed by the fields of its nested tuple if any
+template <class MD, class... Fields>
+std::vector<field_memory> memory_report(const tagged_tuple<MD, Fields...>& t) {
+    std::vector<field_memory> report;
+    size_t position = 0;
+    helper::add_memory_report(t, "", 0, report, position);
+    return report;
+}
+
+// same report summed over all tuples of a collection (empty if the collection is empty)
+template <class MD, class... Fields, class Allocator>
+std::vector<field_memory> memory_report(
+    const std::vector<tagged_tuple<MD, Fields...>, Allocator>& v) {
+    std::vector<field_memory> report;
+    for (auto& t : v) {
+        size_t position = 0;
+        helper::add_memory_report(t, "", 0, report, position);
+    }
+    return report;
+}
+
+// sum of inline, padding and heap bytes of the top-level fields of a report
+inline size_t total_bytes(const std::vector<field_memory>& report) {
+    size_t result = 0;
+    for (auto& entry : report) {
+        if (entry.depth == 0) { result += entry.size + entry.padding + entry.heap_bytes; }
+    }
+    return result;
+}
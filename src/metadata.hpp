@@ -60,3 +60,36 @@ using metadata_has_property = list_contains<Name, map_key_list_t<properties_t<MD
 
 template <class Name, class MD>
 using metadata_get_property = map_element_t<Name, properties_t<MD>>;
+
+//==================================================================================================
+// tuple tags
+
+// fields stored with the layout of a C struct, with offsets known at compile time (see layout.hpp)
+struct standard_layout {};
+
+//==================================================================================================
+// field properties: properties whose value is the type_list of the tags of the fields they apply to
+
+// fields accessed concurrently, stored as std::atomic (see atomic_fields.hpp)
+struct concurrent {};
+
+// fields stored on their own cache line(s) (see cache_line.hpp)
+struct cache_line_isolated {};
+
+// unique_ptr fields whose pointees are allocated from a per-type pool (see pool.hpp)
+struct pooled {};
+
+namespace helper {
+    template <class Name, class Tag, class MD, bool = metadata_has_property<Name, MD>::value>
+    struct field_has_property : std::false_type {};
+
+    template <class Name, class Tag, class MD>
+    struct field_has_property<Name, Tag, MD, true>
+        : list_contains<Tag, metadata_get_property<Name, MD>> {};
+}  // namespace helper
+
+template <class Name, class Tag, class MD>
+struct metadata_field_has_property : helper::field_has_property<Name, Tag, MD> {};
+
+template <class Name, class Tag>
+struct metadata_field_has_property<Name, Tag, no_metadata> : std::false_type {};
@@ -0,0 +1,236 @@
+/*Copyright or © or Copr. CNRS (2019). Contributors:
+- Vincent Lanore. vincent.lanore@gmail.com
+
+This software is a computer program whose purpose is to provide header-only library to create tuple
+indexed by type tags.
+
+This software is governed by the CeCILL-C license under French law and abiding by the rules of
+distribution of free software. You can use, modify and/ or redistribute the software under the terms
+of the CeCILL-C license as circulated by CEA, CNRS and INRIA at the following URL
+"http://www.cecill.info".
+
+As a counterpart to the access to the source code and rights to copy, modify and redistribute
+granted by the license, users are provided only with a limited warranty and the software's author,
+the holder of the economic rights, and the successive licensors have only limited liability.
+
+In this respect, the user's attention is drawn to the risks associated with loading, using,
+modifying and/or developing or reproducing the software by the user in light of its specific status
+of free software, that may mean that it is complicated to manipulate, and that also therefore means
+that it is reserved for developers and experienced professionals having in-depth computer knowledge.
+Users are therefore encouraged to load and test the software's suitability as regards their
+requirements in conditions enabling the security of their systems and/or data to be ensured and,
+more generally, to use and operate it in the same conditions as regards security.
+
+The fact that you are presently reading this means that you have had knowledge of the CeCILL-C
+license and that you accept its terms.*/
+
+#pragma once
+
+#include <cmath>
+#include <cstdint>
+#include <cstdio>
+#include <clocale>
+#include <cstdlib>
+#include <cstring>
+#include <limits>
+#include <type_traits>
+
+/* Locale-independent number formatting and parsing on raw character ranges (no iostream, no
+allocation). Used by the text formats (json, csv). The few numbers that go through snprintf or
+strtod have their decimal point translated from or to the one of the current C locale, so the
+output always uses '.' whatever the locale. */
+
+namespace helper {
+    // decimal point of the current C locale ("." in the "C" locale, "," in many others)
+    inline const char* locale_decimal_point() {
+        const char* point = std::localeconv()->decimal_point;
+        return point != nullptr and point[0] != '\0' ? point : ".";
+    }
+}  // namespace helper
+
+//==================================================================================================
+// formatting; out must have room for number_io_max_chars characters
+
+constexpr size_t number_io_max_chars = 32;
+
+template <class T>
+char* write_integer(char* out, T value) {
+    static_assert(std::is_integral<T>::value, "write_integer expects an integral type");
+    using unsigned_t = std::make_unsigned_t<T>;
+    unsigned_t abs_value = static_cast<unsigned_t>(value);
+    if (value < T(0)) {
+        *out++ = '-';
+        abs_value = unsigned_t(0) - abs_value;
+    }
+    char buffer[number_io_max_chars];
+    char* p = buffer + number_io_max_chars;
+    do {
+        *--p = static_cast<char>('0' + abs_value % 10);
+        abs_value /= 10;
+    } while (abs_value != 0);
+    while (p != buffer + number_io_max_chars) { *out++ = *p++; }
+    return out;
+}
+
+// writes enough digits for the value to be read back exactly; non-finite values are not handled
+inline char* write_double(char* out, double value) {
+    // integral values are frequent (counts, initial values) and can be written exactly as integers
+    if (value == std::floor(value) and std::fabs(value) < 9007199254740992.0 and
+        not(value == 0 and std::signbit(value))) {
+        return write_integer(out, static_cast<int64_t>(value));
+    }
+    char buffer[number_io_max_chars];
+    int n = std::snprintf(buffer, number_io_max_chars, "%.17g", value);
+    const char* point = helper::locale_decimal_point();
+    size_t point_size = std::strlen(point);
+    for (int i = 0; i < n; i++) {
+        if (std::strncmp(buffer + i, point, point_size) == 0) {
+            *out++ = '.';
+            i += static_cast<int>(point_size) - 1;
+        } else {
+            *out++ = buffer[i];
+        }
+    }
+    return out;
+}
+
+//==================================================================================================
+// parsing; functions return a pointer past the parsed number, or nullptr if there is none
+
+template <class T>
+const char* parse_integer(const char* begin, const char* end, T& value) {
+    static_assert(std::is_integral<T>::value, "parse_integer expects an integral type");
+    using unsigned_t = std::make_unsigned_t<T>;
+    bool negative = false;
+    if (begin != end and (*begin == '-' or *begin == '+')) {
+        negative = *begin == '-';
+        if (negative and std::is_unsigned<T>::value) { return nullptr; }
+        begin++;
+    }
+    if (begin == end or *begin < '0' or *begin > '9') { return nullptr; }
+    const unsigned_t max = negative ? unsigned_t(std::numeric_limits<T>::max()) + 1
+                                    : unsigned_t(std::numeric_limits<T>::max());
+    unsigned_t result = 0;
+    for (; begin != end and *begin >= '0' and *begin <= '9'; begin++) {
+        unsigned_t digit = static_cast<unsigned_t>(*begin - '0');
+        if (result > (max - digit) / 10) { return nullptr; }  // overflow
+        result = result * 10 + digit;
+    }
+    value = negative ? static_cast<T>(unsigned_t(0) - result) : static_cast<T>(result);
+    return begin;
+}
+
+namespace helper {
+    constexpr double exact_powers_of_ten[] = {1e0,  1e1,  1e2,  1e3,  1e4,  1e5,  1e6,  1e7,
+                                              1e8,  1e9,  1e10, 1e11, 1e12, 1e13, 1e14, 1e15,
+                                              1e16, 1e17, 1e18, 1e19, 1e20, 1e21, 1e22};
+
+    /* slow path for numbers that cannot be converted exactly with one multiplication; [begin, end)
+    is the number token only, its '.' is replaced by the decimal point strtod expects */
+    inline const char* parse_double_fallback(const char* begin, const char* end, double& value) {
+        char buffer[128];
+        const char* point = locale_decimal_point();
+        size_t point_size = std::strlen(point);
+        size_t size = 0;
+        const char* dot = nullptr;  // position of '.' in the token
+        for (const char* p = begin; p != end; p++) {
+            if (size + point_size >= sizeof(buffer)) { return nullptr; }
+            if (*p == '.' and dot == nullptr) {
+                dot = p;
+                std::memcpy(buffer + size, point, point_size);
+                size += point_size;
+            } else {
+                buffer[size++] = *p;
+            }
+        }
+        buffer[size] = '\0';
+        char* parsed_end;
+        value = std::strtod(buffer, &parsed_end);
+        size_t consumed = static_cast<size_t>(parsed_end - buffer);
+        if (consumed == 0) { return nullptr; }
+        if (dot != nullptr and consumed > static_cast<size_t>(dot - begin)) {
+            consumed -= point_size - 1;
+        }
+        return begin + consumed;
+    }
+}  // namespace helper
+
+/* Decimal to double conversion. Numbers with at most 19 significant digits and a decimal exponent
+within [-22, 22] whose mantissa fits in 53 bits (i.e., nearly all numbers found in data files) are
+converted exactly with a single multiplication or division (Clinger's fast path); other numbers
+go through strtod. Also accepts "nan", "inf" and "infinity". */
+inline const char* parse_double(const char* begin, const char* end, double& value) {
+    const char* p = begin;
+    bool negative = false;
+    if (p != end and (*p == '-' or *p == '+')) {
+        negative = *p == '-';
+        p++;
+    }
+    if (p != end and (*p == 'n' or *p == 'N' or *p == 'i' or *p == 'I')) {
+        const char* token_end = p;
+        while (token_end != end and ((*token_end >= 'a' and *token_end <= 'z') or
+                                     (*token_end >= 'A' and *token_end <= 'Z'))) {
+            token_end++;
+        }
+        return helper::parse_double_fallback(begin, token_end, value);
+    }
+    uint64_t mantissa = 0;
+    int nb_digits = 0, exponent = 0;
+    bool any_digit = false;
+    for (; p != end and *p >= '0' and *p <= '9'; p++) {
+        any_digit = true;
+        if (nb_digits < 19) {
+            mantissa = mantissa * 10 + static_cast<uint64_t>(*p - '0');
+            nb_digits += mantissa != 0;
+        } else {
+            exponent++;
+            nb_digits++;
+        }
+    }
+    if (p != end and *p == '.') {
+        p++;
+        for (; p != end and *p >= '0' and *p <= '9'; p++) {
+            any_digit = true;
+            if (nb_digits < 19) {
+                mantissa = mantissa * 10 + static_cast<uint64_t>(*p - '0');
+                nb_digits += mantissa != 0;
+                exponent--;
+            } else {
+                nb_digits++;
+            }
+        }
+    }
+    if (not any_digit) { return nullptr; }
+    if (p != end and (*p == 'e' or *p == 'E')) {
+        // exponent clamped (beyond, the value is zero or infinite anyway), so that it cannot
+        // overflow; strtod then sees the actual token
+        const int max_exponent = 100000;
+        bool exp_negative = false;
+        p++;
+        if (p != end and (*p == '-' or *p == '+')) {
+            exp_negative = *p == '-';
+            p++;
+        }
+        if (p == end or *p < '0' or *p > '9') { return nullptr; }
+        int exp_value = 0;
+        for (; p != end and *p >= '0' and *p <= '9'; p++) {
+            if (exp_value < max_exponent) { exp_value = exp_value * 10 + (*p - '0'); }
+        }
+        exponent += exp_negative ? -exp_value : exp_value;
+    }
+    if (nb_digits > 19 or mantissa > (uint64_t(1) << 53) or exponent < -22 or exponent > 22) {
+        return helper::parse_double_fallback(begin, p, value);
+    }
+    double result = static_cast<double>(mantissa);
+    result = exponent < 0 ? result / helper::exact_powers_of_ten[-exponent]
+                          : result * helper::exact_powers_of_ten[exponent];
+    value = negative ? -result : result;
+    return p;
+}
+
+inline const char* parse_double(const char* begin, const char* end, float& value) {
+    double result;
+    const char* p = parse_double(begin, end, result);
+    value = static_cast<float>(result);
+    return p;
+}
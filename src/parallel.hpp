@@ -0,0 +1,314 @@
+/*Copyright or © or Copr. CNRS (2019). Contributors:
+- Vincent Lanore. vincent.lanore@gmail.com
+
+This software is a computer program whose purpose is to provide header-only library to create tuple
+indexed by type tags.
+
+This software is governed by the CeCILL-C license under French law and abiding by the rules of
+distribution of free software. You can use, modify and/ or redistribute the software under the terms
+of the CeCILL-C license as circulated by CEA, CNRS and INRIA at the following URL
+"http://www.cecill.info".
+
+As a counterpart to the access to the source code and rights to copy, modify and redistribute
+granted by the license, users are provided only with a limited warranty and the software's author,
+the holder of the economic rights, and the successive licensors have only limited liability.
+
+In this respect, the user's attention is drawn to the risks associated with loading, using,
+modifying and/or developing or reproducing the software by the user in light of its specific status
+of free software, that may mean that it is complicated to manipulate, and that also therefore means
+that it is reserved for developers and experienced professionals having in-depth computer knowledge.
+Users are therefore encouraged to load and test the software's suitability as regards their
+requirements in conditions enabling the security of their systems and/or data to be ensured and,
+more generally, to use and operate it in the same conditions as regards security.
+
+The fact that you are presently reading this means that you have had knowledge of the CeCILL-C
+license and that you accept its terms.*/
+
+#pragma once
+
+#include <atomic>
+#include <cassert>
+#include <condition_variable>
+#include <exception>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+#include "tagged_tuple.hpp"
+
+/* Parallel loops over random-access collections of tagged tuples (std::vector, etc.), run by a
+work-stealing pool. The index range is split evenly between workers (the pool threads plus the
+calling thread); each worker takes chunks from the front of its own range, a quarter of what
+remains each time, so chunks shrink as the range empties. A worker whose range is empty steals the
+back half of another worker's remaining range. Items with very uneven costs thus end up balanced
+without tuning a chunk size. A pool runs one loop at a time; loop bodies must not start loops on
+the same pool. If a loop body throws, workers stop taking chunks and the first exception is
+rethrown in the calling thread once all workers are done. */
+
+class work_stealing_pool {
+    // (padded so that ranges of different workers do not share a cache line; alignas would not
+    // be honored by new[] in C++14)
+    struct worker_range {
+        std::mutex mutex;
+        size_t begin{0}, end{0};
+        char padding[64];
+    };
+
+    using job_t = void (*)(void* context, size_t worker, size_t begin, size_t end);
+
+    std::vector<std::thread> threads;
+    std::unique_ptr<worker_range[]> ranges;
+
+    std::mutex run_mutex;  // serializes calls to run
+    std::mutex mutex;      // protects the fields below
+    std::condition_variable wake, done;
+    job_t job{nullptr};
+    void* context{nullptr};
+    uint64_t generation{0};
+    size_t nb_running{0};
+    bool stop{false};
+    std::exception_ptr error;  // first exception thrown by a body during the current run
+
+    std::atomic<bool> failed{false};  // set when error is set; workers then stop taking chunks
+
+    // next chunk of the worker's own range
+    bool take(size_t worker, size_t& begin, size_t& end) {
+        auto& range = ranges[worker];
+        std::lock_guard<std::mutex> lock(range.mutex);
+        size_t remaining = range.end - range.begin;
+        if (remaining == 0) { return false; }
+        size_t chunk = (remaining + 3) / 4;
+        begin = range.begin;
+        end = begin + chunk;
+        range.begin = end;
+        return true;
+    }
+
+    // moves the back half of another worker's range to the worker's own range
+    bool steal(size_t worker) {
+        size_t n = nb_workers();
+        for (size_t k = 1; k < n; k++) {
+            auto& victim = ranges[(worker + k) % n];
+            size_t begin, end;
+            {
+                std::lock_guard<std::mutex> lock(victim.mutex);
+                size_t remaining = victim.end - victim.begin;
+                if (remaining == 0) { continue; }
+                begin = victim.end - (remaining + 1) / 2;
+                end = victim.end;
+                victim.end = begin;
+            }
+            std::lock_guard<std::mutex> lock(ranges[worker].mutex);
+            ranges[worker].begin = begin;
+            ranges[worker].end = end;
+            return true;
+        }
+        return false;
+    }
+
+    void work(size_t worker, job_t f, void* f_context) {
+        size_t begin, end;
+        while (not failed.load(std::memory_order_relaxed) and
+               (take(worker, begin, end) or (steal(worker) and take(worker, begin, end)))) {
+            try {
+                f(f_context, worker, begin, end);
+            } catch (...) {
+                std::lock_guard<std::mutex> lock(mutex);
+                if (error == nullptr) { error = std::current_exception(); }
+                failed.store(true, std::memory_order_relaxed);
+            }
+        }
+    }
+
+    void thread_loop(size_t worker) {
+        uint64_t seen = 0;
+        std::unique_lock<std::mutex> lock(mutex);
+        while (true) {
+            wake.wait(lock, [&]() { return stop or generation != seen; });
+            if (stop) { return; }
+            seen = generation;
+            job_t f = job;
+            void* f_context = context;
+            lock.unlock();
+            work(worker, f, f_context);
+            lock.lock();
+            if (--nb_running == 0) { done.notify_one(); }
+        }
+    }
+
+    template <class Body>
+    static void call(void* body, size_t worker, size_t begin, size_t end) {
+        (*static_cast<Body*>(body))(worker, begin, end);
+    }
+
+    void stop_threads() {
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            stop = true;
+        }
+        wake.notify_all();
+        for (auto& thread : threads) { thread.join(); }
+    }
+
+  public:
+    // nb_threads pool threads (the thread calling run also works); if a thread cannot be started,
+    // the ones already started are joined before the exception propagates
+    explicit work_stealing_pool(size_t nb_threads)
+        : ranges(new worker_range[nb_threads + 1]) {
+        threads.reserve(nb_threads);
+        try {
+            for (size_t i = 0; i < nb_threads; i++) {
+                threads.emplace_back([this, i]() { thread_loop(i + 1); });
+            }
+        } catch (...) {
+            stop_threads();
+            throw;
+        }
+    }
+
+    work_stealing_pool(const work_stealing_pool&) = delete;
+    work_stealing_pool& operator=(const work_stealing_pool&) = delete;
+
+    ~work_stealing_pool() { stop_threads(); }
+
+    size_t nb_workers() const { return threads.size() + 1; }
+
+    // calls body(worker, begin, end) on disjoint chunks covering [0, n) and waits for completion;
+    // worker is in [0, nb_workers()); rethrows the first exception thrown by body, if any
+    template <class Body>
+    void run(size_t n, Body& body) {
+        std::lock_guard<std::mutex> run_lock(run_mutex);
+        size_t nb = nb_workers();
+        for (size_t w = 0; w < nb; w++) {
+            std::lock_guard<std::mutex> lock(ranges[w].mutex);
+            ranges[w].begin = n * w / nb;
+            ranges[w].end = n * (w + 1) / nb;
+        }
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            job = &call<Body>;
+            context = &body;
+            nb_running = threads.size();
+            generation++;
+        }
+        wake.notify_all();
+        work(0, &call<Body>, &body);
+        std::unique_lock<std::mutex> lock(mutex);
+        done.wait(lock, [&]() { return nb_running == 0; });
+        failed.store(false, std::memory_order_relaxed);
+        if (error != nullptr) {
+            std::exception_ptr e = error;
+            error = nullptr;
+            lock.unlock();
+            std::rethrow_exception(e);
+        }
+    }
+};
+
+// shared pool with one worker per hardware thread
+inline work_stealing_pool& default_pool() {
+    static work_stealing_pool pool(
+        std::thread::hardware_concurrency() > 1 ? std::thread::hardware_concurrency() - 1 : 0);
+    return pool;
+}
+
+//==================================================================================================
+// f(t) for each t of c
+template <class Container, class F>
+void parallel_for_each(Container& c, F f, work_stealing_pool& pool = default_pool()) {
+    auto body = [&](size_t, size_t begin, size_t end) {
+        for (size_t i = begin; i < end; i++) { f(c[i]); }
+    };
+    pool.run(c.size(), body);
+}
+
+// out[i] = f(in[i]); out is resized to the size of in. Workers write disjoint elements of out,
+// which must therefore not share memory words (see the std::vector<bool> overload)
+template <class Container, class OutContainer, class F>
+void parallel_transform(const Container& in, OutContainer& out, F f,
+                        work_stealing_pool& pool = default_pool()) {
+    out.resize(in.size());
+    auto body = [&](size_t, size_t begin, size_t end) {
+        for (size_t i = begin; i < end; i++) { out[i] = f(in[i]); }
+    };
+    pool.run(in.size(), body);
+}
+
+// std::vector<bool> packs elements as bits of shared words: results go through a byte buffer
+template <class Container, class F>
+void parallel_transform(const Container& in, std::vector<bool>& out, F f,
+                        work_stealing_pool& pool = default_pool()) {
+    std::vector<char> bytes;
+    parallel_transform(in, bytes, [&f](const auto& x) -> char { return bool(f(x)); }, pool);
+    out.assign(bytes.begin(), bytes.end());
+}
+
+namespace helper {
+    // per-worker value, padded so that values of different workers share neither a cache line
+    // nor a memory word (e.g. for bool, which std::vector packs)
+    template <class T>
+    struct worker_value {
+        T value;
+        char padding[64];
+    };
+}  // namespace helper
+
+// combine of map(t) over all t of c, starting from init; combine must be associative and
+// commutative, and init neutral (it is used once per worker)
+template <class Container, class T, class Map, class Combine>
+T parallel_reduce(const Container& c, T init, Map map, Combine combine,
+                  work_stealing_pool& pool = default_pool()) {
+    std::vector<helper::worker_value<T>> partials(pool.nb_workers(), {init, {}});
+    auto body = [&](size_t worker, size_t begin, size_t end) {
+        T partial = init;
+        for (size_t i = begin; i < end; i++) { partial = combine(partial, map(c[i])); }
+        partials[worker].value = combine(partials[worker].value, partial);
+    };
+    pool.run(c.size(), body);
+    T result = init;
+    for (auto& partial : partials) { result = combine(result, partial.value); }
+    return result;
+}
+
+//==================================================================================================
+// per-field reductions: the accumulator is a tagged tuple (init) and combiners a tagged tuple with
+// a combiner for each of its tags; every field of the accumulator is reduced with its combiner
+// over the same field of the elements of c. Per-worker accumulators are then merged field by field
+// with mergers (a tagged tuple with the same tags as combiners); init must be neutral for both
+
+namespace helper {
+    template <class Acc, class Combiners, class T, class... Fields>
+    void combine_fields(Acc& acc, const Combiners& combiners, const T& x, type_map<Fields...>) {
+        std::initializer_list<int>{
+            (get<first_t<Fields>>(acc) = get<first_t<Fields>>(combiners)(
+                 get<first_t<Fields>>(acc), get<first_t<Fields>>(x)),
+             0)...};
+    }
+}  // namespace helper
+
+template <class Container, class Acc, class Combiners, class Mergers>
+Acc parallel_reduce_fields(const Container& c, const Acc& init, const Combiners& combiners,
+                           const Mergers& mergers, work_stealing_pool& pool = default_pool()) {
+    std::vector<helper::worker_value<Acc>> partials(pool.nb_workers(), {init, {}});
+    auto body = [&](size_t worker, size_t begin, size_t end) {
+        Acc partial = init;
+        for (size_t i = begin; i < end; i++) {
+            helper::combine_fields(partial, combiners, c[i], field_map_t<Acc>());
+        }
+        helper::combine_fields(partials[worker].value, mergers, partial, field_map_t<Acc>());
+    };
+    pool.run(c.size(), body);
+    Acc result = init;
+    for (auto& partial : partials) {
+        helper::combine_fields(result, mergers, partial.value, field_map_t<Acc>());
+    }
+    return result;
+}
+
+// combiners also merge the per-worker accumulators: each must then accept two accumulated values
+// and be associative and commutative (e.g. sums, min, max, but not counts of elements)
+template <class Container, class Acc, class Combiners>
+Acc parallel_reduce_fields(const Container& c, const Acc& init, const Combiners& combiners,
+                           work_stealing_pool& pool = default_pool()) {
+    return parallel_reduce_fields(c, init, combiners, combiners, pool);
+}
@@ -0,0 +1,197 @@
+/*Copyright or © or Copr. CNRS (2019). Contributors:
+- Vincent Lanore. vincent.lanore@gmail.com
+
+This software is a computer program whose purpose is to provide header-only library to create tuple
+indexed by type tags.
+
+This software is governed by the CeCILL-C license under French law and abiding by the rules of
+distribution of free software. You can use, modify and/ or redistribute the software under the terms
+of the CeCILL-C license as circulated by CEA, CNRS and INRIA at the following URL
+"http://www.cecill.info".
+
+As a counterpart to the access to the source code and rights to copy, modify and redistribute
+granted by the license, users are provided only with a limited warranty and the software's author,
+the holder of the economic rights, and the successive licensors have only limited liability.
+
+In this respect, the user's attention is drawn to the risks associated with loading, using,
+modifying and/or developing or reproducing the software by the user in light of its specific status
+of free software, that may mean that it is complicated to manipulate, and that also therefore means
+that it is reserved for developers and experienced professionals having in-depth computer knowledge.
+Users are therefore encouraged to load and test the software's suitability as regards their
+requirements in conditions enabling the security of their systems and/or data to be ensured and,
+more generally, to use and operate it in the same conditions as regards security.
+
+The fact that you are presently reading this means that you have had knowledge of the CeCILL-C
+license and that you accept its terms.*/
+
+#pragma once
+
+#include <new>
+#include "tagged_tuple.hpp"
+
+/* Pooled allocation for unique_ptr fields listed in the pooled property of a tuple's metadata,
+e.g. metadata<type_list<>, type_map<property<pooled, type_list<alpha_>>>>. Such fields are stored
+as a pooled_ptr<T>, which behaves like std::unique_ptr<T> (move-only, get<Key> returns the
+pointee) but takes its memory from object_pool<T>: freed blocks go to a free list local to the
+freeing thread and are reused by the next allocations in that thread, without calling malloc or
+free. Each free list keeps at most max_free_blocks blocks (the rest is returned to operator
+delete), so that threads freeing objects allocated by other threads do not grow without bound. */
+
+//==================================================================================================
+template <class T>
+class object_pool {
+    union node {
+        node* next;
+        typename std::aligned_storage<sizeof(T), alignof(T)>::type storage;
+    };
+
+    struct free_list {
+        node* head{nullptr};
+        size_t size{0};
+
+        ~free_list() {
+            while (head != nullptr) {
+                node* next = head->next;
+                delete head;
+                head = next;
+            }
+        }
+    };
+
+    static free_list& local() {
+        static thread_local free_list list;
+        return list;
+    }
+
+  public:
+    static constexpr size_t max_free_blocks = 4096;
+
+    // uninitialized memory for a T
+    static void* allocate() {
+        auto& list = local();
+        if (list.head == nullptr) { return new node; }
+        node* result = list.head;
+        list.head = result->next;
+        list.size--;
+        return result;
+    }
+
+    static void deallocate(void* p) {
+        auto& list = local();
+        node* block = static_cast<node*>(p);
+        if (list.size >= max_free_blocks) {
+            delete block;
+            return;
+        }
+        block->next = list.head;
+        list.head = block;
+        list.size++;
+    }
+
+    // number of free blocks available to the calling thread
+    static size_t nb_free() { return local().size; }
+};
+
+template <class T>
+constexpr size_t object_pool<T>::max_free_blocks;
+
+//==================================================================================================
+template <class T>
+class pooled_ptr {
+    T* p{nullptr};
+
+    // (the block goes back to the pool if the constructor throws)
+    template <class... Args>
+    static T* create(Args&&... args) {
+        void* memory = object_pool<T>::allocate();
+        try {
+            return new (memory) T(std::forward<Args>(args)...);
+        } catch (...) {
+            object_pool<T>::deallocate(memory);
+            throw;
+        }
+    }
+
+  public:
+    pooled_ptr() = default;
+
+    // from unique_ptr_field in make_tagged_tuple: the value goes directly into pooled memory
+    pooled_ptr(helper::unique_ptr_init<T> init) : p(create(std::move(init.value))) {}
+
+    // moves the pointee of a unique_ptr into pooled memory
+    pooled_ptr(std::unique_ptr<T>&& other) : p(other ? create(std::move(*other)) : nullptr) {
+        other.reset();
+    }
+
+    pooled_ptr(const pooled_ptr&) = delete;
+    pooled_ptr(pooled_ptr&& other) : p(other.p) { other.p = nullptr; }
+
+    pooled_ptr& operator=(const pooled_ptr&) = delete;
+    pooled_ptr& operator=(pooled_ptr&& other) {
+        if (this != &other) {
+            reset();
+            p = other.p;
+            other.p = nullptr;
+        }
+        return *this;
+    }
+
+    ~pooled_ptr() { reset(); }
+
+    template <class... Args>
+    static pooled_ptr make(Args&&... args) {
+        pooled_ptr result;
+        result.p = create(std::forward<Args>(args)...);
+        return result;
+    }
+
+    void reset() {
+        if (p != nullptr) {
+            p->~T();
+            object_pool<T>::deallocate(p);
+            p = nullptr;
+        }
+    }
+
+    T* get() const { return p; }
+    T& operator*() const { return *p; }
+    T* operator->() const { return p; }
+    explicit operator bool() const { return p != nullptr; }
+};
+
+template <class T, class... Args>
+pooled_ptr<T> make_pooled(Args&&... args) {
+    return pooled_ptr<T>::make(std::forward<Args>(args)...);
+}
+
+template <class T>
+T& deref_if_ptr(pooled_ptr<T>& x) {
+    assert(x.get() != nullptr);
+    return *x;
+}
+
+template <class T>
+const T& deref_if_ptr(const pooled_ptr<T>& x) {
+    assert(x.get() != nullptr);
+    return *x;
+}
+
+template <class T>
+bool is_null_field(const pooled_ptr<T>& x) {
+    return x.get() == nullptr;
+}
+
+template <class T>
+struct is_nullable_field<pooled_ptr<T>> : std::true_type {};
+
+template <class T>
+T* emplace_field_value(pooled_ptr<T>& x) {
+    if (x.get() == nullptr) { x = make_pooled<T>(); }
+    return x.get();
+}
+
+template <class T>
+bool reset_field(pooled_ptr<T>& x) {
+    x.reset();
+    return true;
+}
@@ -68,4 +68,75 @@ template <class T>
 const auto& deref_if_ptr(const T* x) {
     assert(x != nullptr);
     return *x;
-}
\ No newline at end of file
+}
+
+//==================================================================================================
+// generic algorithms (comparison, hashing, text and binary formats...) see a field through
+// field_value_ptr: the value behind pointers and storage wrappers, or nullptr for a null pointer.
+// Pointer-like field storages provide is_null_field next to their deref_if_ptr.
+
+template <class T>
+bool is_null_field(const T&) {
+    return false;
+}
+
+template <class T>
+bool is_null_field(const std::unique_ptr<T>& x) {
+    return x == nullptr;
+}
+
+template <class T>
+bool is_null_field(T* x) {
+    return x == nullptr;
+}
+
+template <class T>
+auto field_value_ptr(T& x) {
+    return is_null_field(x) ? nullptr : &deref_if_ptr(x);
+}
+
+// readers (text and binary formats) write fields through emplace_field_value, which allocates a
+// default value in a null owning pointer (nullptr if it cannot, e.g. a null raw pointer), and set
+// nullable fields to null with reset_field (false if the field cannot be reset)
+
+template <class T>
+struct is_nullable_field : std::false_type {};
+
+template <class T>
+struct is_nullable_field<std::unique_ptr<T>> : std::true_type {};
+
+template <class T>
+struct is_nullable_field<T*> : std::true_type {};
+
+template <class T>
+auto emplace_field_value(T& x) {
+    return &deref_if_ptr(x);
+}
+
+template <class T>
+T* emplace_field_value(std::unique_ptr<T>& x) {
+    if (x == nullptr) { x = std::make_unique<T>(); }
+    return x.get();
+}
+
+template <class T>
+T* emplace_field_value(T* x) {
+    return x;
+}
+
+template <class T>
+bool reset_field(T&) {
+    return false;
+}
+
+template <class T>
+bool reset_field(std::unique_ptr<T>& x) {
+    x.reset();
+    return true;
+}
+
+// raw pointers are not owned: only a null pointer can be read as null
+template <class T>
+bool reset_field(T* x) {
+    return x == nullptr;
+}
@@ -0,0 +1,118 @@
+/*Copyright or © or Copr. CNRS (2019). Contributors:
+- Vincent Lanore. vincent.lanore@gmail.com
+
+This software is a computer program whose purpose is to provide header-only library to create tuple
+indexed by type tags.
+
+This software is governed by the CeCILL-C license under French law and abiding by the rules of
+distribution of free software. You can use, modify and/ or redistribute the software under the terms
+of the CeCILL-C license as circulated by CEA, CNRS and INRIA at the following URL
+"http://www.cecill.info".
+
+As a counterpart to the access to the source code and rights to copy, modify and redistribute
+granted by the license, users are provided only with a limited warranty and the software's author,
+the holder of the economic rights, and the successive licensors have only limited liability.
+
+In this respect, the user's attention is drawn to the risks associated with loading, using,
+modifying and/or developing or reproducing the software by the user in light of its specific status
+of free software, that may mean that it is complicated to manipulate, and that also therefore means
+that it is reserved for developers and experienced professionals having in-depth computer knowledge.
+Users are therefore encouraged to load and test the software's suitability as regards their
+requirements in conditions enabling the security of their systems and/or data to be ensured and,
+more generally, to use and operate it in the same conditions as regards security.
+
+The fact that you are presently reading this means that you have had knowledge of the CeCILL-C
+license and that you accept its terms.*/
+
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <cassert>
+#include <thread>
+
+/* Single-writer publication of successive states through a small set of preallocated buffers.
+The writer builds the next state in a free buffer (back()) and publishes it with one atomic store
+of the current buffer index. Readers pin the current buffer (read()) and get const access to it
+without copying. A buffer is reused by the writer only once no reader pins it, so publishing never
+allocates and readers never lock; the writer waits only if every non-current buffer is pinned by a
+long-lived reader. */
+
+template <class TTuple, size_t NbBuffers = 3>
+class published {
+    static_assert(NbBuffers >= 2, "published needs at least two buffers");
+    static constexpr size_t no_buffer = NbBuffers;
+
+    std::array<TTuple, NbBuffers> buffers;
+    mutable std::array<std::atomic<uint32_t>, NbBuffers> pins{};  // readers per buffer
+    std::atomic<size_t> current{0};
+    std::atomic<uint64_t> epoch_{0};  // number of publications
+    size_t back_index{no_buffer};     // buffer acquired by the writer
+
+  public:
+    // pins a buffer for the lifetime of the guard
+    class read_guard {
+        const published* p;
+        size_t index;
+
+      public:
+        read_guard(const published* p, size_t index) : p(p), index(index) {}
+        read_guard(const read_guard&) = delete;
+        read_guard(read_guard&& other) : p(other.p), index(other.index) { other.p = nullptr; }
+        ~read_guard() {
+            if (p != nullptr) { p->pins[index].fetch_sub(1, std::memory_order_release); }
+        }
+
+        const TTuple& get() const { return p->buffers[index]; }
+        const TTuple& operator*() const { return get(); }
+        const TTuple* operator->() const { return &get(); }
+    };
+
+    published() = default;
+
+    explicit published(const TTuple& initial) {
+        for (auto& buffer : buffers) { buffer = initial; }
+    }
+
+    // reader side: current state, valid until the guard is destroyed
+    read_guard read() const {
+        while (true) {
+            size_t index = current.load();
+            pins[index].fetch_add(1);
+            if (current.load() == index) { return read_guard(this, index); }
+            pins[index].fetch_sub(1, std::memory_order_release);  // published meanwhile; retry
+        }
+    }
+
+    // writer side: free buffer in which to build the next state. It contains a previously
+    // published state, so containers keep their capacity.
+    TTuple& back() {
+        while (back_index == no_buffer) {
+            size_t cur = current.load(std::memory_order_relaxed);
+            for (size_t i = 0; i < NbBuffers and back_index == no_buffer; i++) {
+                if (i != cur and pins[i].load() == 0) { back_index = i; }
+            }
+            if (back_index == no_buffer) { std::this_thread::yield(); }
+        }
+        std::atomic_thread_fence(std::memory_order_acquire);  // last readers are done with it
+        return buffers[back_index];
+    }
+
+    // writer side: makes the state built in back() the current state
+    void publish() {
+        assert(back_index != no_buffer);
+        current.store(back_index);
+        epoch_.fetch_add(1, std::memory_order_release);
+        back_index = no_buffer;
+    }
+
+    void publish(const TTuple& state) {
+        back() = state;
+        publish();
+    }
+
+    uint64_t epoch() const { return epoch_.load(std::memory_order_acquire); }
+};
+
+template <class TTuple, size_t NbBuffers>
+constexpr size_t published<TTuple, NbBuffers>::no_buffer;
@@ -0,0 +1,168 @@
+/*Copyright or © or Copr. CNRS (2019). Contributors:
+- Vincent Lanore. vincent.lanore@gmail.com
+
+This software is a computer program whose purpose is to provide header-only library to create tuple
+indexed by type tags.
+
+This software is governed by the CeCILL-C license under French law and abiding by the rules of
+distribution of free software. You can use, modify and/ or redistribute the software under the terms
+of the CeCILL-C license as circulated by CEA, CNRS and INRIA at the following URL
+"http://www.cecill.info".
+
+As a counterpart to the access to the source code and rights to copy, modify and redistribute
+granted by the license, users are provided only with a limited warranty and the software's author,
+the holder of the economic rights, and the successive licensors have only limited liability.
+
+In this respect, the user's attention is drawn to the risks associated with loading, using,
+modifying and/or developing or reproducing the software by the user in light of its specific status
+of free software, that may mean that it is complicated to manipulate, and that also therefore means
+that it is reserved for developers and experienced professionals having in-depth computer knowledge.
+Users are therefore encouraged to load and test the software's suitability as regards their
+requirements in conditions enabling the security of their systems and/or data to be ensured and,
+more generally, to use and operate it in the same conditions as regards security.
+
+The fact that you are presently reading this means that you have had knowledge of the CeCILL-C
+license and that you accept its terms.*/
+
+
+#pragma once
+
+#include <array>
+#include <memory>
+#include <string>
+#include <vector>
+#include "tag_name.hpp"
+
+/* Compile-time hash of the schema of a tagged tuple: tag names, field types and nested tuples.
+schema_hash<TTuple> is a constexpr uint64_t built only from names spelled in the source, not from
+the way the compiler prints or mangles types, so GCC and Clang builds agree on it. Metadata tags
+and field properties (e.g. standard_layout, concurrent) are not part of the schema. Field types
+are identified by stable_type_hash<T>: arithmetic types by kind, signedness and size, standard
+containers and smart pointers by kind and element type, tagged tuples by their schema hash. Other
+types (user structs, enums) fall back to their qualified name, which is only stable for
+non-template types declared at namespace scope; specialize stable_type_hash for the others. */
+
+template <class T, class Count>
+class counted_ptr;  // shared_field.hpp
+
+template <class T>
+class cow_ptr;  // cow.hpp
+
+namespace helper {
+    template <class TTuple>
+    struct schema_hash_impl;
+
+    // hash of a type constructor applied to the hash of its argument
+    constexpr uint64_t type_node_hash(const_string kind, uint64_t argument = 0) {
+        return mix_hash(fnv1a(kind) ^ mix_hash(argument));
+    }
+
+    template <class T>
+    using is_sized_number = std::integral_constant<
+        bool, std::is_arithmetic<T>::value and not std::is_same<T, bool>::value and
+                  not std::is_same<T, char>::value>;
+
+    constexpr const_string number_kind(bool floating, bool is_signed) {
+        return floating ? "float" : is_signed ? "int" : "uint";
+    }
+}  // namespace helper
+
+//==================================================================================================
+// stable type hashes
+
+template <class T, class = void>
+struct stable_type_hash
+    : std::integral_constant<uint64_t, helper::type_node_hash("type", fnv1a(type_name<T>()))> {};
+
+template <>
+struct stable_type_hash<bool> : std::integral_constant<uint64_t, helper::type_node_hash("bool")> {
+};
+
+template <>
+struct stable_type_hash<char> : std::integral_constant<uint64_t, helper::type_node_hash("char")> {
+};
+
+// int32_t is the same number whether it is spelled int or long
+template <class T>
+struct stable_type_hash<T, std::enable_if_t<helper::is_sized_number<T>::value>>
+    : std::integral_constant<uint64_t, helper::type_node_hash(
+                                           helper::number_kind(std::is_floating_point<T>::value,
+                                                               std::is_signed<T>::value),
+                                           sizeof(T))> {};
+
+template <class Char, class Traits, class Alloc>
+struct stable_type_hash<std::basic_string<Char, Traits, Alloc>>
+    : std::integral_constant<uint64_t,
+                             helper::type_node_hash("string", stable_type_hash<Char>::value)> {};
+
+template <class T, class Alloc>
+struct stable_type_hash<std::vector<T, Alloc>>
+    : std::integral_constant<uint64_t,
+                             helper::type_node_hash("vector", stable_type_hash<T>::value)> {};
+
+template <class T, size_t N>
+struct stable_type_hash<std::array<T, N>>
+    : std::integral_constant<uint64_t, helper::type_node_hash("array", stable_type_hash<T>::value ^
+                                                                           helper::mix_hash(N))> {};
+
+template <class T, class Deleter>
+struct stable_type_hash<std::unique_ptr<T, Deleter>>
+    : std::integral_constant<uint64_t,
+                             helper::type_node_hash("unique_ptr", stable_type_hash<T>::value)> {};
+
+// a pooled field holds the same value as a unique_ptr field, only its allocation differs
+template <class T>
+struct stable_type_hash<pooled_ptr<T>> : stable_type_hash<std::unique_ptr<T>> {};
+
+// shared fields are the same schema whatever their count type
+template <class T, class Count>
+struct stable_type_hash<counted_ptr<T, Count>>
+    : std::integral_constant<uint64_t,
+                             helper::type_node_hash("shared", stable_type_hash<T>::value)> {};
+
+template <class T>
+struct stable_type_hash<cow_ptr<T>>
+    : std::integral_constant<uint64_t, helper::type_node_hash("cow", stable_type_hash<T>::value)> {
+};
+
+template <class T>
+struct stable_type_hash<T*>
+    : std::integral_constant<uint64_t,
+                             helper::type_node_hash("pointer", stable_type_hash<T>::value)> {};
+
+template <class T>
+struct stable_type_hash<T&>
+    : std::integral_constant<uint64_t,
+                             helper::type_node_hash("reference", stable_type_hash<T>::value)> {};
+
+template <class MD, class... Fields>
+struct stable_type_hash<tagged_tuple<MD, Fields...>>
+    : std::integral_constant<uint64_t,
+                             helper::type_node_hash(
+                                 "tagged_tuple",
+                                 helper::schema_hash_impl<tagged_tuple<MD, Fields...>>::value())> {
+};
+
+//==================================================================================================
+// schema hash
+
+namespace helper {
+    template <class MD, class... Fields>
+    struct schema_hash_impl<tagged_tuple<MD, Fields...>> {
+        static constexpr uint64_t value() {
+            uint64_t ids[] = {0, mix_hash(fnv1a(tag_name<first_t<Fields>>()) ^
+                                          stable_type_hash<second_t<Fields>>::value)...};
+            uint64_t result = sizeof...(Fields);
+            for (uint64_t id : ids) { result = mix_hash(result ^ id); }
+            return result;
+        }
+    };
+}  // namespace helper
+
+template <class TTuple>
+constexpr uint64_t schema_hash = helper::schema_hash_impl<TTuple>::value();
+
+template <class MD, class... Fields>
+constexpr uint64_t schema_hash_of(const tagged_tuple<MD, Fields...>&) {
+    return schema_hash<tagged_tuple<MD, Fields...>>;
+}
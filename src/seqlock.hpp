@@ -0,0 +1,87 @@
+/*Copyright or © or Copr. CNRS (2019). Contributors:
+- Vincent Lanore. vincent.lanore@gmail.com
+
+This software is a computer program whose purpose is to provide header-only library to create tuple
+indexed by type tags.
+
+This software is governed by the CeCILL-C license under French law and abiding by the rules of
+distribution of free software. You can use, modify and/ or redistribute the software under the terms
+of the CeCILL-C license as circulated by CEA, CNRS and INRIA at the following URL
+"http://www.cecill.info".
+
+As a counterpart to the access to the source code and rights to copy, modify and redistribute
+granted by the license, users are provided only with a limited warranty and the software's author,
+the holder of the economic rights, and the successive licensors have only limited liability.
+
+In this respect, the user's attention is drawn to the risks associated with loading, using,
+modifying and/or developing or reproducing the software by the user in light of its specific status
+of free software, that may mean that it is complicated to manipulate, and that also therefore means
+that it is reserved for developers and experienced professionals having in-depth computer knowledge.
+Users are therefore encouraged to load and test the software's suitability as regards their
+requirements in conditions enabling the security of their systems and/or data to be ensured and,
+more generally, to use and operate it in the same conditions as regards security.
+
+The fact that you are presently reading this means that you have had knowledge of the CeCILL-C
+license and that you accept its terms.*/
+
+#pragma once
+
+#include <atomic>
+#include <cstring>
+#include <thread>
+#include "bitwise_traits.hpp"
+
+/* Seqlock-protected tuple: writers bump a sequence number to an odd value, modify the tuple and
+bump it again; readers copy the whole tuple without locking and retry if the sequence number
+changed in the meantime. Readers never block writers, so this suits state that is read often by
+monitoring threads and written by a hot loop. Tuples must have trivially copyable fields: a copy
+that races with a write is discarded, which is only safe if copying does not follow pointers. */
+
+template <class TTuple>
+class seqlocked {
+    static_assert(has_trivially_copyable_fields<TTuple>::value,
+                  "seqlocked requires a tuple with trivially copyable fields");
+
+    std::atomic<uint64_t> sequence{0};
+    TTuple t;
+
+  public:
+    seqlocked() = default;
+    explicit seqlocked(const TTuple& t) : t(t) {}
+
+    // calls f(TTuple&); concurrent writers are serialized
+    template <class F>
+    void write(F&& f) {
+        uint64_t seq = sequence.load(std::memory_order_relaxed);
+        while (seq % 2 != 0 or
+               not sequence.compare_exchange_weak(seq, seq + 1, std::memory_order_acquire,
+                                                  std::memory_order_relaxed)) {
+            if (seq % 2 != 0) {
+                std::this_thread::yield();
+                seq = sequence.load(std::memory_order_relaxed);
+            }
+        }
+        std::atomic_thread_fence(std::memory_order_release);
+        f(t);
+        sequence.store(seq + 2, std::memory_order_release);
+    }
+
+    // consistent copy of the tuple, taken without locking
+    TTuple read_snapshot() const {
+        typename std::aligned_storage<sizeof(TTuple), alignof(TTuple)>::type buffer;
+        while (true) {
+            uint64_t seq = sequence.load(std::memory_order_acquire);
+            if (seq % 2 != 0) {
+                std::this_thread::yield();
+                continue;
+            }
+            std::memcpy(&buffer, &t, sizeof(TTuple));
+            std::atomic_thread_fence(std::memory_order_acquire);
+            if (sequence.load(std::memory_order_relaxed) == seq) { break; }
+        }
+        return *reinterpret_cast<const TTuple*>(&buffer);
+    }
+
+    // number of completed writes
+    uint64_t version() const { return sequence.load(std::memory_order_acquire) / 2; }
+};
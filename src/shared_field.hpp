@@ -0,0 +1,192 @@
+/*Copyright or © or Copr. CNRS (2019). Contributors:
+- Vincent Lanore. vincent.lanore@gmail.com
+
+This software is a computer program whose purpose is to provide header-only library to create tuple
+indexed by type tags.
+
+This software is governed by the CeCILL-C license under French law and abiding by the rules of
+distribution of free software. You can use, modify and/ or redistribute the software under the terms
+of the CeCILL-C license as circulated by CEA, CNRS and INRIA at the following URL
+"http://www.cecill.info".
+
+As a counterpart to the access to the source code and rights to copy, modify and redistribute
+granted by the license, users are provided only with a limited warranty and the software's author,
+the holder of the economic rights, and the successive licensors have only limited liability.
+
+In this respect, the user's attention is drawn to the risks associated with loading, using,
+modifying and/or developing or reproducing the software by the user in light of its specific status
+of free software, that may mean that it is complicated to manipulate, and that also therefore means
+that it is reserved for developers and experienced professionals having in-depth computer knowledge.
+Users are therefore encouraged to load and test the software's suitability as regards their
+requirements in conditions enabling the security of their systems and/or data to be ensured and,
+more generally, to use and operate it in the same conditions as regards security.
+
+The fact that you are presently reading this means that you have had knowledge of the CeCILL-C
+license and that you accept its terms.*/
+
+#pragma once
+
+#include <atomic>
+#include "tagged_tuple.hpp"
+
+/* Shared-ownership field storage with an intrusive reference count: the count is stored in the
+same heap block as the value, so there is one allocation and no separate control block (no weak
+count, no type-erased deleter). shared_value<T> uses an atomic count and can be shared between
+threads; local_shared_value<T> uses a plain count and must only be copied and destroyed within one
+thread, which avoids atomic operations. Copies share the value; get<Key> returns it mutably. */
+
+//==================================================================================================
+namespace helper {
+    template <class T, class Count>
+    struct counted_block {
+        Count count;
+        T value;
+
+        template <class... Args>
+        explicit counted_block(Args&&... args) : count(1), value(std::forward<Args>(args)...) {}
+    };
+
+    inline void count_increment(std::atomic<size_t>& count) {
+        count.fetch_add(1, std::memory_order_relaxed);
+    }
+
+    inline void count_increment(size_t& count) { count++; }
+
+    // true if the count reached zero
+    inline bool count_decrement(std::atomic<size_t>& count) {
+        return count.fetch_sub(1, std::memory_order_acq_rel) == 1;
+    }
+
+    inline bool count_decrement(size_t& count) { return --count == 0; }
+
+    inline size_t count_value(const std::atomic<size_t>& count) {
+        return count.load(std::memory_order_acquire);
+    }
+
+    inline size_t count_value(const size_t& count) { return count; }
+}  // namespace helper
+
+//==================================================================================================
+template <class T, class Count>
+class counted_ptr {
+  protected:
+    using block = helper::counted_block<T, Count>;
+    block* b;
+
+    // drops the reference held by this handle without deleting: true if it was the last one, in
+    // which case the caller deletes the block once it no longer uses b
+    bool release() { return b != nullptr and helper::count_decrement(b->count); }
+
+  public:
+    using element_type = T;
+    using count_type = Count;
+
+    // value built from args (not a copy of another counted_ptr)
+    template <class... Args, class = std::enable_if_t<
+                                 not helper::is_single_arg_of_type<counted_ptr, Args...>::value>>
+    explicit counted_ptr(Args&&... args) : b(new block(std::forward<Args>(args)...)) {}
+
+    // (copies of a moved-from counted_ptr are empty too)
+    counted_ptr(const counted_ptr& other) : b(other.b) {
+        if (b != nullptr) { helper::count_increment(b->count); }
+    }
+
+    counted_ptr(counted_ptr&& other) : b(other.b) { other.b = nullptr; }
+
+    counted_ptr& operator=(const counted_ptr& other) {
+        if (other.b != nullptr) { helper::count_increment(other.b->count); }
+        block* old = release() ? b : nullptr;
+        b = other.b;
+        delete old;
+        return *this;
+    }
+
+    counted_ptr& operator=(counted_ptr&& other) {
+        if (this != &other) {
+            block* old = release() ? b : nullptr;
+            b = other.b;
+            other.b = nullptr;
+            delete old;
+        }
+        return *this;
+    }
+
+    ~counted_ptr() {
+        if (release()) { delete b; }
+    }
+
+    T& get() const {
+        assert(b != nullptr);
+        return b->value;
+    }
+
+    // number of counted_ptr sharing the value
+    size_t use_count() const { return b == nullptr ? 0 : helper::count_value(b->count); }
+};
+
+template <class T>
+using shared_value = counted_ptr<T, std::atomic<size_t>>;
+
+template <class T>
+using local_shared_value = counted_ptr<T, size_t>;
+
+template <class T, class Count>
+T& deref_if_ptr(counted_ptr<T, Count>& x) {
+    return x.get();
+}
+
+template <class T, class Count>
+const T& deref_if_ptr(const counted_ptr<T, Count>& x) {
+    return x.get();
+}
+
+// (only moved-from handles are null)
+template <class T, class Count>
+bool is_null_field(const counted_ptr<T, Count>& x) {
+    return x.use_count() == 0;
+}
+
+//==================================================================================================
+// to be used in make_tagged_tuple calls: shared_field<Tag>(value) stores a new shared value, and
+// shared_field<Tag>(p) with p a shared_value shares p's value (e.g. a sub-model used by several
+// components)
+
+namespace helper {
+    template <class T>
+    struct is_counted_ptr : std::false_type {};
+
+    template <class T, class Count>
+    struct is_counted_ptr<counted_ptr<T, Count>> : std::true_type {};
+
+    template <class Tag, class Count, class Type>
+    auto counted_field(Type&& data, std::false_type /* handle */) {
+        using value_type = std::decay_t<Type>;
+        return TagValuePair<Tag, counted_ptr<value_type, Count>>(
+            counted_ptr<value_type, Count>(std::forward<Type>(data)));
+    }
+
+    // copies the handle (shares the value), or takes it over if it is an rvalue
+    template <class Tag, class Count, class Handle>
+    auto counted_field(Handle&& p, std::true_type /* handle */) {
+        using handle_t = std::decay_t<Handle>;
+        static_assert(std::is_same<typename handle_t::count_type, Count>::value,
+                      "shared_field takes a shared_value, local_shared_field a local_shared_value");
+        return TagValuePair<Tag, handle_t>(std::forward<Handle>(p));
+    }
+
+    template <class Tag, class Count, class Type>
+    auto counted_field(Type&& data) {
+        return counted_field<Tag, Count>(std::forward<Type>(data),
+                                         is_counted_ptr<std::decay_t<Type>>());
+    }
+}  // namespace helper
+
+template <class Tag, class Type>
+auto shared_field(Type&& data) {
+    return helper::counted_field<Tag, std::atomic<size_t>>(std::forward<Type>(data));
+}
+
+template <class Tag, class Type>
+auto local_shared_field(Type&& data) {
+    return helper::counted_field<Tag, size_t>(std::forward<Type>(data));
+}
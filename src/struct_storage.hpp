@@ -0,0 +1,284 @@
+/*Copyright or © or Copr. CNRS (2019). Contributors:
+- Vincent Lanore. vincent.lanore@gmail.com
+
+This software is a computer program whose purpose is to provide header-only library to create tuple
+indexed by type tags.
+
+This software is governed by the CeCILL-C license under French law and abiding by the rules of
+distribution of free software. You can use, modify and/ or redistribute the software under the terms
+of the CeCILL-C license as circulated by CEA, CNRS and INRIA at the following URL
+"http://www.cecill.info".
+
+As a counterpart to the access to the source code and rights to copy, modify and redistribute
+granted by the license, users are provided only with a limited warranty and the software's author,
+the holder of the economic rights, and the successive licensors have only limited liability.
+
+In this respect, the user's attention is drawn to the risks associated with loading, using,
+modifying and/or developing or reproducing the software by the user in light of its specific status
+of free software, that may mean that it is complicated to manipulate, and that also therefore means
+that it is reserved for developers and experienced professionals having in-depth computer knowledge.
+Users are therefore encouraged to load and test the software's suitability as regards their
+requirements in conditions enabling the security of their systems and/or data to be ensured and,
+more generally, to use and operate it in the same conditions as regards security.
+
+The fact that you are presently reading this means that you have had knowledge of the CeCILL-C
+license and that you accept its terms.*/
+
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <new>
+#include <tuple>
+#include <utility>
+
+/* Storage with the layout of a C struct declaring the same members in the same order: each field
+is placed at the first offset after the previous one that satisfies its alignment, and the total
+size is rounded up to the largest alignment. Reference fields are stored as pointers. Unlike
+std::tuple, whose layout is unspecified (libstdc++ stores fields in reverse order), offsets are
+known at compile time. Used by tagged tuples with the standard_layout metadata tag; accessed with
+get<I> like std::tuple. */
+
+//==================================================================================================
+namespace helper {
+    template <class T>
+    using struct_slot_t =
+        std::conditional_t<std::is_reference<T>::value, std::remove_reference_t<T>*, T>;
+
+    template <class... Ts>
+    struct struct_layout {
+        static constexpr size_t nb_fields = sizeof...(Ts);
+
+        static constexpr size_t alignment() {
+            size_t result = 1;
+            for (size_t a : {size_t(1), alignof(struct_slot_t<Ts>)...}) {
+                result = a > result ? a : result;
+            }
+            return result;
+        }
+
+        // offset of field i (i == nb_fields gives the end of the last field)
+        static constexpr size_t offset(size_t i) {
+            size_t sizes[] = {size_t(0), sizeof(struct_slot_t<Ts>)...};
+            size_t alignments[] = {size_t(1), alignof(struct_slot_t<Ts>)...};
+            size_t result = 0;
+            for (size_t j = 0; j < i; j++) {
+                size_t a = alignments[j + 1];
+                result = (result + a - 1) / a * a + sizes[j + 1];
+            }
+            size_t a = i < nb_fields ? alignments[i + 1] : 1;
+            return (result + a - 1) / a * a;
+        }
+
+        static constexpr size_t size() {
+            size_t end = nb_fields == 0 ? 1 : offset(nb_fields);
+            return (end + alignment() - 1) / alignment() * alignment();
+        }
+
+        static constexpr std::array<size_t, nb_fields> sizes() {
+            return {{sizeof(struct_slot_t<Ts>)...}};
+        }
+
+        static constexpr std::array<size_t, nb_fields> offsets() {
+            return offsets(std::index_sequence_for<Ts...>());
+        }
+
+        template <size_t... Is>
+        static constexpr std::array<size_t, nb_fields> offsets(std::index_sequence<Is...>) {
+            return {{offset(Is)...}};
+        }
+    };
+
+    template <class T>
+    T* to_struct_slot(T& x, std::true_type /* is reference */) {
+        return &x;
+    }
+
+    template <class U>
+    U&& to_struct_slot(U&& x, std::false_type /* is reference */) {
+        return std::forward<U>(x);
+    }
+
+    template <class T>
+    T& from_struct_slot(T* x, std::true_type /* is reference */) {
+        return *x;
+    }
+
+    template <class T>
+    T& from_struct_slot(T& x, std::false_type /* is reference */) {
+        return x;
+    }
+
+    template <class T>
+    void destroy_struct_slot(T& x) {
+        x.~T();
+    }
+
+    // is the argument list a single T or object derived from T (i.e. a constructor call would be a
+    // copy or move)?
+    template <class T, class... Args>
+    struct is_single_arg_of_type : std::false_type {};
+
+    template <class T, class Arg>
+    struct is_single_arg_of_type<T, Arg> : std::is_base_of<T, std::decay_t<Arg>> {};
+}  // namespace helper
+
+//==================================================================================================
+template <class... Ts>
+class struct_storage {
+  public:
+    using layout = helper::struct_layout<Ts...>;
+
+    template <size_t I>
+    using element_t = std::tuple_element_t<I, std::tuple<Ts...>>;
+
+  private:
+    template <size_t I>
+    using slot_t = helper::struct_slot_t<element_t<I>>;
+
+    template <size_t I>
+    using is_ref = std::is_reference<element_t<I>>;
+
+    using indices = std::index_sequence_for<Ts...>;
+
+    alignas(layout::alignment()) unsigned char bytes[layout::size()];
+
+    template <size_t I>
+    slot_t<I>& slot() {
+        return *reinterpret_cast<slot_t<I>*>(bytes + layout::offset(I));
+    }
+
+    template <size_t I>
+    const slot_t<I>& slot() const {
+        return *reinterpret_cast<const slot_t<I>*>(bytes + layout::offset(I));
+    }
+
+    // slots are constructed in order, counting those built: if one throws, the ones already built
+    // are destroyed (in reverse order) before rethrowing
+    template <class... Args, size_t... Is>
+    void construct(std::index_sequence<Is...> is, Args&&... args) {
+        size_t nb_built = 0;
+        try {
+            std::initializer_list<int>{(new (&slot<Is>()) slot_t<Is>(helper::to_struct_slot(
+                                            std::forward<Args>(args), is_ref<Is>())),
+                                        nb_built++, 0)...};
+        } catch (...) {
+            destroy(nb_built, is);
+            throw;
+        }
+    }
+
+    template <size_t I>
+    void destroy_if(bool built) {
+        if (built) { helper::destroy_struct_slot(slot<I>()); }
+    }
+
+    // destroys the first nb slots, in reverse construction order
+    template <size_t... Is>
+    void destroy(size_t nb, std::index_sequence<Is...>) {
+        std::initializer_list<int>{
+            (destroy_if<sizeof...(Is) - 1 - Is>(sizeof...(Is) - 1 - Is < nb), 0)...};
+    }
+
+    // like std::tuple, references are assigned through
+    template <size_t... Is>
+    void copy_assign(const struct_storage& other, std::index_sequence<Is...>) {
+        std::initializer_list<int>{(get<Is>() = other.get<Is>(), 0)...};
+    }
+
+    template <size_t... Is>
+    void move_assign(struct_storage& other, std::index_sequence<Is...>) {
+        std::initializer_list<int>{
+            (get<Is>() = std::forward<element_t<Is>>(other.get<Is>()), 0)...};
+    }
+
+    template <size_t... Is>
+    void construct_default(std::index_sequence<Is...> is) {
+        size_t nb_built = 0;
+        try {
+            std::initializer_list<int>{(new (&slot<Is>()) slot_t<Is>(), nb_built++, 0)...};
+        } catch (...) {
+            destroy(nb_built, is);
+            throw;
+        }
+    }
+
+    template <size_t... Is>
+    void construct_copy(const struct_storage& other, std::index_sequence<Is...> is) {
+        size_t nb_built = 0;
+        try {
+            std::initializer_list<int>{
+                (new (&slot<Is>()) slot_t<Is>(other.slot<Is>()), nb_built++, 0)...};
+        } catch (...) {
+            destroy(nb_built, is);
+            throw;
+        }
+    }
+
+    template <size_t... Is>
+    void construct_move(struct_storage& other, std::index_sequence<Is...> is) {
+        size_t nb_built = 0;
+        try {
+            std::initializer_list<int>{
+                (new (&slot<Is>()) slot_t<Is>(std::move(other.slot<Is>())), nb_built++, 0)...};
+        } catch (...) {
+            destroy(nb_built, is);
+            throw;
+        }
+    }
+
+  public:
+    struct_storage() { construct_default(indices()); }
+
+    // one argument per field
+    template <class... Args,
+              class = std::enable_if_t<
+                  sizeof...(Args) == sizeof...(Ts) and sizeof...(Ts) != 0 and
+                  not helper::is_single_arg_of_type<struct_storage, Args...>::value>>
+    explicit struct_storage(Args&&... args) {
+        construct(indices(), std::forward<Args>(args)...);
+    }
+
+    struct_storage(const struct_storage& other) { construct_copy(other, indices()); }
+    struct_storage(struct_storage&& other) { construct_move(other, indices()); }
+
+    struct_storage& operator=(const struct_storage& other) {
+        copy_assign(other, indices());
+        return *this;
+    }
+
+    struct_storage& operator=(struct_storage&& other) {
+        move_assign(other, indices());
+        return *this;
+    }
+
+    ~struct_storage() { destroy(sizeof...(Ts), indices()); }
+
+    template <size_t I>
+    element_t<I>& get() {
+        return helper::from_struct_slot(slot<I>(), is_ref<I>());
+    }
+
+    template <size_t I>
+    std::add_lvalue_reference_t<std::add_const_t<element_t<I>>> get() const {
+        return helper::from_struct_slot(slot<I>(), is_ref<I>());
+    }
+};
+
+template <size_t I, class... Ts>
+auto& get(struct_storage<Ts...>& s) {
+    return s.template get<I>();
+}
+
+template <size_t I, class... Ts>
+auto& get(const struct_storage<Ts...>& s) {
+    return s.template get<I>();
+}
+
+namespace std {
+    template <class... Ts>
+    struct tuple_size<struct_storage<Ts...>> : integral_constant<size_t, sizeof...(Ts)> {};
+
+    template <size_t I, class... Ts>
+    struct tuple_element<I, struct_storage<Ts...>> : tuple_element<I, tuple<Ts...>> {};
+}  // namespace std
@@ -0,0 +1,113 @@
+/*Copyright or © or Copr. CNRS (2019). Contributors:
+- Vincent Lanore. vincent.lanore@gmail.com
+
+This software is a computer program whose purpose is to provide header-only library to create tuple
+indexed by type tags.
+
+This software is governed by the CeCILL-C license under French law and abiding by the rules of
+distribution of free software. You can use, modify and/ or redistribute the software under the terms
+of the CeCILL-C license as circulated by CEA, CNRS and INRIA at the following URL
+"http://www.cecill.info".
+
+As a counterpart to the access to the source code and rights to copy, modify and redistribute
+granted by the license, users are provided only with a limited warranty and the software's author,
+the holder of the economic rights, and the successive licensors have only limited liability.
+
+In this respect, the user's attention is drawn to the risks associated with loading, using,
+modifying and/or developing or reproducing the software by the user in light of its specific status
+of free software, that may mean that it is complicated to manipulate, and that also therefore means
+that it is reserved for developers and experienced professionals having in-depth computer knowledge.
+Users are therefore encouraged to load and test the software's suitability as regards their
+requirements in conditions enabling the security of their systems and/or data to be ensured and,
+more generally, to use and operate it in the same conditions as regards security.
+
+The fact that you are presently reading this means that you have had knowledge of the CeCILL-C
+license and that you accept its terms.*/
+
+#pragma once
+
+#include <array>
+#include "const_string.hpp"
+#include "tagged_tuple.hpp"
+
+//==================================================================================================
+// type names extracted from __PRETTY_FUNCTION__ at compile time (no demangling, no allocation)
+
+namespace helper {
+    // pretty is of the form "... pretty_function() [with T = name]" (gcc) or "[T = name]" (clang)
+    constexpr const_string extract_type_name(const_string pretty) {
+        size_t start = pretty.find('[');
+        start = pretty.find('=', start) + 2;
+        size_t end = start;
+        int depth = 0;
+        for (; end < pretty.size(); end++) {
+            char c = pretty[end];
+            if (c == '<' or c == '(') {
+                depth++;
+            } else if (c == '>' or c == ')') {
+                depth--;
+            } else if (depth == 0 and (c == ']' or c == ';')) {
+                break;
+            }
+        }
+        return pretty.substr(start, end - start);
+    }
+
+    template <class T>
+    constexpr const_string pretty_function() {
+        return const_string(__PRETTY_FUNCTION__, sizeof(__PRETTY_FUNCTION__) - 1);
+    }
+
+    template <class Tag, class = void>
+    struct has_const_name : std::false_type {};
+
+    template <class Tag>
+    struct has_const_name<Tag, decltype(void(Tag::to_const_string()))> : std::true_type {};
+
+    template <class Tag>
+    constexpr const_string tag_name_impl(std::true_type /* has const name */) {
+        return Tag::to_const_string();
+    }
+
+    template <class Tag>
+    constexpr const_string tag_name_impl(std::false_type /* has const name */) {
+        return extract_type_name(pretty_function<Tag>());
+    }
+}  // namespace helper
+
+// compiler spelling of a type, e.g. "int", "ns::my_struct" or "std::unique_ptr<double>"
+template <class T>
+constexpr const_string type_name() {
+    return helper::extract_type_name(helper::pretty_function<T>());
+}
+
+// name of a tag: the TOKEN name if the tag was declared with TOKEN, its type name otherwise
+template <class Tag>
+constexpr const_string tag_name() {
+    return helper::tag_name_impl<Tag>(helper::has_const_name<Tag>());
+}
+
+//==================================================================================================
+// names of all fields of a tagged tuple, in field order
+
+namespace helper {
+    template <class TTuple>
+    struct field_names_impl;
+
+    template <class MD, class... Fields>
+    struct field_names_impl<tagged_tuple<MD, Fields...>> {
+        static constexpr std::array<const_string, sizeof...(Fields)> get() {
+            return {{tag_name<first_t<Fields>>()...}};
+        }
+    };
+}  // namespace helper
+
+template <class TTuple>
+constexpr std::array<const_string, tuple_nb_fields<TTuple>::value> field_names() {
+    return helper::field_names_impl<TTuple>::get();
+}
+
+template <class MD, class... Fields>
+constexpr auto field_names(const tagged_tuple<MD, Fields...>&) {
+    return field_names<tagged_tuple<MD, Fields...>>();
+}
@@ -29,17 +29,98 @@ license and that you accept its terms.*/
 #include "metadata.hpp"
 #include "minimpl/src/type_map.hpp"
 #include "ptr_utils.hpp"
+#include "struct_storage.hpp"
 
 template <class T, class U>
 using field = type_pair<T, U>;
 
 struct tuple_construct {};
 
+//==================================================================================================
+// field storage: some metadata properties change the type used to store a field (the wrappers are
+// defined in the corresponding headers)
+
+template <class T>
+class atomic_value;  // atomic_fields.hpp
+
+template <class T>
+class isolated_value;  // cache_line.hpp
+
+template <class T>
+class pooled_ptr;  // pool.hpp
+
+namespace helper {
+    template <class T, bool pooled>
+    struct pool_if {
+        using type = T;
+    };
+
+    template <class T>
+    struct pool_if<T, true> {
+        static_assert(sizeof(T) == 0, "Only unique_ptr fields can be pooled");
+    };
+
+    template <class T>
+    struct pool_if<std::unique_ptr<T>, true> {
+        using type = pooled_ptr<T>;
+    };
+
+    template <class Wrapper, bool apply>
+    struct wrap_if {
+        using type = Wrapper;
+    };
+
+    template <template <class> class Wrapper, class T>
+    struct wrap_if<Wrapper<T>, false> {
+        using type = T;
+    };
+
+    template <class Name, class Tag, class MD, template <class> class Wrapper, class T>
+    using wrap_if_property_t =
+        typename wrap_if<Wrapper<T>, metadata_field_has_property<Name, Tag, MD>::value>::type;
+}  // namespace helper
+
+template <class MD, class Tag, class Type>
+using field_storage_t = helper::wrap_if_property_t<
+    cache_line_isolated, Tag, MD, isolated_value,
+    helper::wrap_if_property_t<
+        concurrent, Tag, MD, atomic_value,
+        typename helper::pool_if<Type, metadata_field_has_property<pooled, Tag, MD>::value>::type>>;
+
+template <class MD, class Field>
+using storage_field_t =
+    field<first_t<Field>, field_storage_t<MD, first_t<Field>, second_t<Field>>>;
+
+// storage of all fields: a std::tuple, or a struct_storage for tuples tagged standard_layout
+namespace helper {
+    template <class MD>
+    struct uses_struct_storage : metadata_has_tag<standard_layout, MD> {};
+
+    template <>
+    struct uses_struct_storage<no_metadata> : std::false_type {};
+
+    template <class StorageMap, bool struct_layout>
+    struct tuple_storage {
+        using type = map_value_list_t<StorageMap>;
+    };
+
+    template <class... Fields>
+    struct tuple_storage<type_map<Fields...>, true> {
+        using type = struct_storage<second_t<Fields>...>;
+    };
+}  // namespace helper
+
+template <class MD, class StorageMap>
+using tuple_storage_t =
+    typename helper::tuple_storage<StorageMap, helper::uses_struct_storage<MD>::value>::type;
+
+//==================================================================================================
 template <class Metadata, class... Fields>
 struct tagged_tuple {
     using field_map = type_map<Fields...>;
+    using storage_map = type_map<storage_field_t<Metadata, Fields>...>;
     using metadata = Metadata;
-    map_value_list_t<field_map> data;
+    tuple_storage_t<Metadata, storage_map> data;
 
     tagged_tuple() = default;
 
@@ -58,16 +139,59 @@ struct is_tagged_tuple : std::false_type {};
 template <class MD, class... Fields>
 struct is_tagged_tuple<tagged_tuple<MD, Fields...>> : std::true_type {};
 
+//==================================================================================================
+// access counting (see access_count.hpp): enabled for tuples whose metadata has the count_accesses
+// tag, or for all tuples if TAGGED_TUPLE_COUNT_ACCESSES is defined
+
+struct count_accesses;
+
+namespace helper {
+#ifdef TAGGED_TUPLE_COUNT_ACCESSES
+    template <class MD>
+    struct counts_accesses : std::true_type {};
+#else
+    template <class MD>
+    struct counts_accesses : metadata_has_tag<count_accesses, MD> {};
+
+    template <>
+    struct counts_accesses<no_metadata> : std::false_type {};
+#endif
+
+    struct access_count_tag {};
+
+    // the counting overload (taking an access_count_tag) is in access_count.hpp, found by ADL
+    template <class TTuple, class Key, class Tag>
+    void count_access_impl(Tag) {
+        static_assert(sizeof(Tag) == 0,
+                      "Access counting is enabled for this tuple (count_accesses metadata tag or "
+                      "TAGGED_TUPLE_COUNT_ACCESSES): include access_count.hpp");
+    }
+
+    template <class TTuple, class Key>
+    void count_access(std::true_type) {
+        count_access_impl<TTuple, Key>(access_count_tag());
+    }
+
+    template <class TTuple, class Key>
+    void count_access(std::false_type) {}
+}  // namespace helper
+
 //==================================================================================================
 template <class Key, class MD, class... Fields>
 auto& get(tagged_tuple<MD, Fields...>& t) {
+    static_assert(not metadata_field_has_property<concurrent, Key, MD>::value,
+                  "Field is concurrent: use load/store/fetch_add from atomic_fields.hpp");
     constexpr size_t index = map_element_index<Key, type_map<Fields...>>::value;
+    helper::count_access<tagged_tuple<MD, Fields...>, Key>(helper::counts_accesses<MD>());
     return deref_if_ptr(get<index>(t.data));
 }
 
 template <class Key, class MD, class... Fields>
 const auto& get(const tagged_tuple<MD, Fields...>& t) {
+    static_assert(not metadata_field_has_property<concurrent, Key, MD>::value,
+                  "Field is concurrent: use load/store/fetch_add from atomic_fields.hpp");
     constexpr size_t index = map_element_index<Key, type_map<Fields...>>::value;
+    helper::count_access<tagged_tuple<MD, Fields...>, Key>(helper::counts_accesses<MD>());
     return deref_if_ptr(get<index>(t.data));
 }
 
@@ -141,11 +265,29 @@ auto ref_field(Type& data) {
     return TagValuePair<Tag, Type&>(data);
 }
 
+namespace helper {
+    // converts to the storage of a unique_ptr field: std::unique_ptr, or pooled_ptr for pooled
+    // fields (pool.hpp), so that the pointee is allocated only once the storage is known
+    template <class T>
+    struct unique_ptr_init {
+        T& value;
+        operator std::unique_ptr<T>() const { return std::make_unique<T>(std::move(value)); }
+    };
+}  // namespace helper
+
+template <class Tag, class Type>
+struct UniquePtrValuePair {
+    using field_type = type_pair<Tag, std::unique_ptr<Type>>;
+    Type data;
+    template <class InitType>
+    explicit UniquePtrValuePair(InitType&& data) : data(std::forward<InitType>(data)) {}
+    auto move() { return helper::unique_ptr_init<Type>{data}; }
+};
+
 // to be used in make_tagged_tuple calls; builds a unique pointer to Type from Type constructor args
 template <class Tag, class Type>
 auto unique_ptr_field(Type&& data) {
-    return TagValuePair<Tag, std::unique_ptr<Type>>(
-        std::make_unique<Type>(std::forward<Type>(data)));
+    return UniquePtrValuePair<Tag, std::decay_t<Type>>(std::forward<Type>(data));
 }
 
 template <class MD = no_metadata, class... TVPairs>
@@ -161,6 +303,14 @@ auto make_tagged_tuple(TVPairs&&... pairs) {
 template <class Tag, class TTuple>
 using field_type = map_element_t<Tag, field_map_t<TTuple>>;
 
+// number of fields
+template <class TTuple>
+struct tuple_nb_fields;
+
+template <class MD, class... Fields>
+struct tuple_nb_fields<tagged_tuple<MD, Fields...>>
+    : std::integral_constant<size_t, sizeof...(Fields)> {};
+
 template <class Tag, class MD, class... Fields>
 constexpr bool has_tag(const tagged_tuple<MD, Fields...>&) {
     return metadata_has_tag<Tag, MD>::value;
@@ -169,4 +319,8 @@ constexpr bool has_tag(const tagged_tuple<MD, Fields...>&) {
 template <class Tag, class MD, class... Fields>
 constexpr bool has_property(const tagged_tuple<MD, Fields...>&) {
     return metadata_has_property<Tag, MD>::value;
-}
\ No newline at end of file
+}
+
+#ifdef TAGGED_TUPLE_COUNT_ACCESSES
+#include "access_count.hpp"
+#endif
@@ -0,0 +1,264 @@
+/*Copyright or © or Copr. CNRS (2019). Contributors:
+- Vincent Lanore. vincent.lanore@gmail.com
+
+This software is a computer program whose purpose is to provide header-only library to create tuple
+indexed by type tags.
+
+This software is governed by the CeCILL-C license under French law and abiding by the rules of
+distribution of free software. You can use, modify and/ or redistribute the software under the terms
+of the CeCILL-C license as circulated by CEA, CNRS and INRIA at the following URL
+"http://www.cecill.info".
+
+As a counterpart to the access to the source code and rights to copy, modify and redistribute
+granted by the license, users are provided only with a limited warranty and the software's author,
+the holder of the economic rights, and the successive licensors have only limited liability.
+
+In this respect, the user's attention is drawn to the risks associated with loading, using,
+modifying and/or developing or reproducing the software by the user in light of its specific status
+of free software, that may mean that it is complicated to manipulate, and that also therefore means
+that it is reserved for developers and experienced professionals having in-depth computer knowledge.
+Users are therefore encouraged to load and test the software's suitability as regards their
+requirements in conditions enabling the security of their systems and/or data to be ensured and,
+more generally, to use and operate it in the same conditions as regards security.
+
+The fact that you are presently reading this means that you have had knowledge of the CeCILL-C
+license and that you accept its terms.*/
+
+#pragma once
+
+#include <cassert>
+#include <exception>
+#include <new>
+#include <tuple>
+#include "tagged_tuple.hpp"
+
+/* Sum-type counterpart of tagged_tuple: a tagged_variant<field<A, T1>, field<B, T2>, ...> holds
+exactly one value, of one of the alternatives, identified by its tag. The value is stored inline
+(no allocation). Operations that depend on the active alternative (visit, copy, move, destruction)
+go through a table of function pointers indexed by the active alternative, i.e. a single indirect
+call instead of a chain of tests or a virtual call. A variant whose value was destroyed to make
+room for a new one whose construction threw holds no value (index() == npos) until it is assigned
+or emplaced again; visiting it throws bad_tagged_variant_access. */
+
+template <class Tag>
+struct in_place_tag {};
+
+struct bad_tagged_variant_access : std::exception {
+    const char* what() const noexcept override { return "tagged_variant holds no value"; }
+};
+
+namespace helper {
+    constexpr size_t max_of(std::initializer_list<size_t> values) {
+        size_t result = 0;
+        for (size_t v : values) { result = v > result ? v : result; }
+        return result;
+    }
+}  // namespace helper
+
+//==================================================================================================
+template <class... Fields>
+class tagged_variant {
+    static_assert(sizeof...(Fields) > 0, "tagged_variant needs at least one alternative");
+
+  public:
+    using field_map = type_map<Fields...>;
+    static constexpr size_t nb_alternatives = sizeof...(Fields);
+    static constexpr size_t npos = size_t(-1);
+
+    template <size_t I>
+    using alternative_t = second_t<std::tuple_element_t<I, std::tuple<Fields...>>>;
+
+    template <class Tag>
+    static constexpr size_t index_of() {
+        static_assert(list_contains<Tag, map_key_list_t<field_map>>::value,
+                      "Tag is not an alternative of this tagged_variant");
+        return map_element_index<Tag, field_map>::value;
+    }
+
+  private:
+    using indices = std::index_sequence_for<Fields...>;
+
+    std::aligned_storage_t<helper::max_of({sizeof(second_t<Fields>)...}),
+                           helper::max_of({alignof(second_t<Fields>)...})>
+        storage;
+    size_t index_;
+
+    template <size_t I>
+    static void destroy_alternative(tagged_variant& v) {
+        using T = alternative_t<I>;
+        v.template unchecked_get<I>().~T();
+    }
+
+    template <size_t I>
+    static void copy_alternative(tagged_variant& v, const tagged_variant& other) {
+        new (&v.storage) alternative_t<I>(other.template unchecked_get<I>());
+    }
+
+    template <size_t I>
+    static void move_alternative(tagged_variant& v, tagged_variant& other) {
+        new (&v.storage) alternative_t<I>(std::move(other.template unchecked_get<I>()));
+    }
+
+    // leaves the variant without value
+    template <size_t... Is>
+    void destroy(std::index_sequence<Is...>) {
+        using fun_t = void (*)(tagged_variant&);
+        static constexpr fun_t table[] = {&destroy_alternative<Is>...};
+        if (index_ != npos) { table[index_](*this); }
+        index_ = npos;
+    }
+
+    // (the variant must not hold a value)
+    template <size_t... Is>
+    void copy_from(const tagged_variant& other, std::index_sequence<Is...>) {
+        using fun_t = void (*)(tagged_variant&, const tagged_variant&);
+        static constexpr fun_t table[] = {&copy_alternative<Is>...};
+        if (other.index_ != npos) { table[other.index_](*this, other); }
+        index_ = other.index_;
+    }
+
+    template <size_t... Is>
+    void move_from(tagged_variant& other, std::index_sequence<Is...>) {
+        using fun_t = void (*)(tagged_variant&, tagged_variant&);
+        static constexpr fun_t table[] = {&move_alternative<Is>...};
+        if (other.index_ != npos) { table[other.index_](*this, other); }
+        index_ = other.index_;
+    }
+
+  public:
+    // holds a value-initialized first alternative
+    tagged_variant() : index_(0) { new (&storage) alternative_t<0>(); }
+
+    template <class Tag, class... Args>
+    explicit tagged_variant(in_place_tag<Tag>, Args&&... args) : index_(index_of<Tag>()) {
+        new (&storage) alternative_t<index_of<Tag>()>(std::forward<Args>(args)...);
+    }
+
+    tagged_variant(const tagged_variant& other) : index_(npos) { copy_from(other, indices()); }
+    tagged_variant(tagged_variant&& other) : index_(npos) { move_from(other, indices()); }
+
+    // the copy is made before the old value is destroyed, so a throwing copy leaves *this as is
+    tagged_variant& operator=(const tagged_variant& other) {
+        if (this != &other) { *this = tagged_variant(other); }
+        return *this;
+    }
+
+    // (if the move constructor throws, the variant is left without value)
+    tagged_variant& operator=(tagged_variant&& other) {
+        if (this != &other) {
+            destroy(indices());
+            move_from(other, indices());
+        }
+        return *this;
+    }
+
+    ~tagged_variant() { destroy(indices()); }
+
+    /* replaces the current value by an alternative built from args; the value is built before the
+    current one is destroyed (args may refer to it, and a throwing constructor leaves the variant
+    unchanged), then moved in */
+    template <class Tag, class... Args>
+    auto& emplace(Args&&... args) {
+        constexpr size_t index = index_of<Tag>();
+        alternative_t<index> value(std::forward<Args>(args)...);
+        destroy(indices());
+        new (&storage) alternative_t<index>(std::move(value));
+        index_ = index;
+        return unchecked_get<index>();
+    }
+
+    // index of the active alternative, in declaration order (npos if the variant has no value)
+    size_t index() const { return index_; }
+
+    bool valueless() const { return index_ == npos; }
+
+    // access to alternative I, which must be the active one
+    template <size_t I>
+    alternative_t<I>& unchecked_get() {
+        assert(index_ == I);
+        return *reinterpret_cast<alternative_t<I>*>(&storage);
+    }
+
+    template <size_t I>
+    const alternative_t<I>& unchecked_get() const {
+        assert(index_ == I);
+        return *reinterpret_cast<const alternative_t<I>*>(&storage);
+    }
+};
+
+template <class... Fields>
+constexpr size_t tagged_variant<Fields...>::nb_alternatives;
+
+template <class... Fields>
+constexpr size_t tagged_variant<Fields...>::npos;
+
+template <class T>
+struct is_tagged_variant : std::false_type {};
+
+template <class... Fields>
+struct is_tagged_variant<tagged_variant<Fields...>> : std::true_type {};
+
+//==================================================================================================
+template <class TVariant, class Tag, class... Args>
+TVariant make_tagged_variant(Args&&... args) {
+    return TVariant(in_place_tag<Tag>(), std::forward<Args>(args)...);
+}
+
+template <class Tag, class... Fields>
+bool holds(const tagged_variant<Fields...>& v) {
+    return v.index() == tagged_variant<Fields...>::template index_of<Tag>();
+}
+
+// pointer to the value if the alternative Tag is active, nullptr otherwise
+template <class Tag, class... Fields>
+auto get_if(tagged_variant<Fields...>& v) {
+    constexpr size_t index = tagged_variant<Fields...>::template index_of<Tag>();
+    return v.index() == index ? &v.template unchecked_get<index>() : nullptr;
+}
+
+template <class Tag, class... Fields>
+auto get_if(const tagged_variant<Fields...>& v) {
+    constexpr size_t index = tagged_variant<Fields...>::template index_of<Tag>();
+    return v.index() == index ? &v.template unchecked_get<index>() : nullptr;
+}
+
+// the alternative Tag must be active
+template <class Tag, class... Fields>
+auto& get(tagged_variant<Fields...>& v) {
+    return v.template unchecked_get<tagged_variant<Fields...>::template index_of<Tag>()>();
+}
+
+template <class Tag, class... Fields>
+const auto& get(const tagged_variant<Fields...>& v) {
+    return v.template unchecked_get<tagged_variant<Fields...>::template index_of<Tag>()>();
+}
+
+//==================================================================================================
+// visit(v, f) calls f with the active value; f must return the same type for all alternatives.
+// Throws bad_tagged_variant_access if v holds no value
+
+namespace helper {
+    template <size_t I, class R, class Variant, class F>
+    R visit_alternative(Variant& v, F& f) {
+        return f(v.template unchecked_get<I>());
+    }
+
+    template <class Variant, class F, size_t... Is>
+    decltype(auto) visit_variant(Variant& v, F& f, std::index_sequence<Is...>) {
+        using R = decltype(f(v.template unchecked_get<0>()));
+        using fun_t = R (*)(Variant&, F&);
+        static constexpr fun_t table[] = {&visit_alternative<Is, R, Variant, F>...};
+        if (v.valueless()) { throw bad_tagged_variant_access(); }
+        return table[v.index()](v, f);
+    }
+}  // namespace helper
+
+template <class F, class... Fields>
+decltype(auto) visit(tagged_variant<Fields...>& v, F&& f) {
+    return helper::visit_variant(v, f, std::index_sequence_for<Fields...>());
+}
+
+template <class F, class... Fields>
+decltype(auto) visit(const tagged_variant<Fields...>& v, F&& f) {
+    return helper::visit_variant(v, f, std::index_sequence_for<Fields...>());
+}
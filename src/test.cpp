@@ -27,10 +27,36 @@ license and that you accept its terms.*/
 #define DOCTEST_CONFIG_IMPLEMENT_WITH_MAIN
 #include "doctest.h"
 
+#include <cstring>
 #include <string>
-// #include "debug_tools.hpp"
+#include <thread>
+#include "access_count.hpp"
+#include "async_construct.hpp"
+#include "atomic_fields.hpp"
+#include "binary.hpp"
+#include "cache_line.hpp"
+#include "comparison.hpp"
+#include "cow.hpp"
+#include "csv.hpp"
+#include "debug_tools.hpp"
+#include "dynamic_tuple.hpp"
+#include "ensemble.hpp"
 #include "fancy_syntax.hpp"
+#include "hash.hpp"
+#include "json.hpp"
+#include "layout.hpp"
+#include "memory_report.hpp"
+#include "parallel.hpp"
+#include "pool.hpp"
+#include "published.hpp"
+#include "schema_hash.hpp"
+#include "seqlock.hpp"
+#include "shared_field.hpp"
+#include "tag_name.hpp"
 #include "tagged_tuple.hpp"
+#include "tagged_variant.hpp"
+#include "transaction.hpp"
+#include "visit_by_name.hpp"
 using std::string;
 
 struct alpha_ {};
@@ -166,38 +192,1393 @@ TEST_CASE("Fancy token/make syntax") {
     CHECK(get<t3>(t) == 2.3);
 }
 
-// TEST_CASE("basic type printing") { CHECK(type_to_string<alpha_>() == "alpha_"); }
-
-// TEST_CASE("struct printing") {
-//     using tuple_t = tagged_tuple<field<alpha_, int>, field<beta_, double>>;
-//     tuple_t t;
-//     t.data = std::make_tuple(1, 3.2);
-//     std::string debug = type_to_string(t);
-//     CHECK(debug == "tagged_tuple { int alpha_; double beta_; }");
-// }
-
-// TEST_CASE("Struct printing with non-default constructible stuff") {
-//     double a = 3.2;
-//     auto inner = make_tagged_tuple(ref_field<alpha_>(a));
-//     auto outer = make_tagged_tuple(value_field<beta_>(inner));
-//     CHECK(type_to_string(outer) == "tagged_tuple { tagged_tuple { double& alpha_; } beta_;
-// }");
-// }
-
-// TEST_CASE("Struct printing with unique_pointers") {
-//     auto t = make_tagged_tuple(unique_ptr_field<alpha_>(3.2));
-//     CHECK(type_to_string(t) == "tagged_tuple { unique_ptr<double> alpha_; }");
-// }
-
-// TEST_CASE("recursive struct printing") {
-//     using tuple_t = tagged_tuple<field<alpha_, int>, field<beta_, double>>;
-//     using tuple2_t = tagged_tuple<field<alpha_, tuple_t>, field<beta_, tuple_t>>;
-//     tuple2_t t;
-//     get<alpha_>(t).data = std::make_tuple(2, 3.9);
-//     get<beta_>(t).data = std::make_tuple(0, 3.2);
-//     std::string debug = type_to_string(t);
-//     CHECK(debug ==
-//           "tagged_tuple { tagged_tuple { int alpha_; double beta_; } alpha_; tagged_tuple {
-// int "
-//           "alpha_; double beta_; } beta_; }");
-// }
\ No newline at end of file
+TEST_CASE("Transaction rollback and commit") {
+    auto inner = make_tagged_tuple(value_field<alpha_>(1), value_field<beta_>(2.5));
+    auto t = make_tagged_tuple(value_field<alpha_>(3), unique_ptr_field<beta_>(3.2),
+                               value_field<gamma_>(inner), value_field<delta_>(string("hello")));
+    {
+        auto tx = transaction(t);
+        get<alpha_>(tx) = 5;
+        get<alpha_>(tx) = 6;
+        get<beta_>(tx) = 4.1;
+        get<gamma_, beta_>(tx) = 1.5;
+        CHECK(tx.nb_touched() == 3);
+        CHECK(get<alpha_>(t) == 6);
+        CHECK(get<beta_>(t) == 4.1);
+        CHECK((get<gamma_, beta_>(t) == 1.5));
+        tx.rollback();
+        CHECK(tx.nb_touched() == 0);
+        CHECK(get<alpha_>(t) == 3);
+        CHECK(get<beta_>(t) == 3.2);
+        CHECK((get<gamma_, alpha_>(t) == 1));
+        CHECK((get<gamma_, beta_>(t) == 2.5));
+
+        get<delta_>(tx) = "world";
+        get<gamma_, alpha_>(tx) = 7;
+        tx.commit();
+        CHECK(get<delta_>(t) == "world");
+        CHECK((get<gamma_, alpha_>(t) == 7));
+        CHECK((get<gamma_, alpha_>(static_cast<const decltype(tx)&>(tx)) == 7));
+
+        get<alpha_>(tx) = 8;  // pending when tx goes out of scope
+    }
+    CHECK(get<alpha_>(t) == 3);
+    CHECK(get<delta_>(t) == "world");
+
+    // untouched fields are not dereferenced: null pointers, shared copy-on-write values
+    auto u = make_tagged_tuple(cow_field<alpha_>(std::vector<int>(10, 1)), value_field<beta_>(1),
+                               value_field<gamma_>(std::unique_ptr<double>()));
+    auto shared = std::get<0>(u.data);
+    CHECK(shared.use_count() == 2);
+    {
+        auto tx = transaction(u);
+        get<beta_>(tx) = 2;
+        CHECK(std::get<0>(u.data).use_count() == 2);
+        tx.rollback();
+        get<alpha_>(tx).push_back(2);  // clones the shared value
+        CHECK(std::get<0>(u.data).use_count() == 1);
+        CHECK(shared.read().size() == 10);
+    }
+    CHECK(get<alpha_>(u).size() == 10);
+    CHECK(get<beta_>(u) == 1);
+}
+
+namespace test_ns {
+    struct epsilon_ {};
+}  // namespace test_ns
+
+TEST_CASE("Compile-time tag names") {
+    static_assert(tag_name<t1>() == "t1", "");
+    static_assert(tag_name<alpha_>() == "alpha_", "");
+    static_assert(tag_name<test_ns::epsilon_>() == "test_ns::epsilon_", "");
+    static_assert(type_name<int>() == "int", "");
+    static_assert(type_name<std::unique_ptr<double>>().size() > 0, "");
+    CHECK(t1::to_string() == tag_name<t1>().str());
+
+    using tuple_t = tagged_tuple<no_metadata, field<alpha_, int>, field<t2, double>>;
+    constexpr auto names = field_names<tuple_t>();
+    static_assert(names.size() == 2, "");
+    static_assert(names[0] == "alpha_" and names[1] == "t2", "");
+    CHECK(field_names(tuple_t())[1].str() == "t2");
+}
+
+struct set_to_7 {
+    template <class T>
+    void operator()(T& value) {
+        value = 7;
+    }
+    template <class MD, class... Fields>
+    void operator()(tagged_tuple<MD, Fields...>&) {}
+};
+
+struct sum_values {
+    double sum{0};
+    template <class T>
+    void operator()(const T& value) {
+        sum += value;
+    }
+    template <class MD, class... Fields>
+    void operator()(const tagged_tuple<MD, Fields...>&) {}
+};
+
+TEST_CASE("Field access by name") {
+    auto branch = make_tagged_tuple(value_field<t1>(0.5), value_field<t2>(3));
+    auto t = make_tagged_tuple(value_field<alpha_>(2), unique_ptr_field<beta_>(3.2),
+                               value_field<gamma_>(branch));
+    CHECK(field_index_by_name<decltype(t)>("beta_") == 1);
+    CHECK(field_index_by_name<decltype(t)>("zeta_") == -1);
+
+    std::string visited;
+    auto record = [&visited](auto& value) { visited += std::to_string(sizeof(value)); };
+    CHECK(visit_by_name(t, "alpha_", record));
+    CHECK(visited == "4");
+    CHECK(not visit_by_name(t, "alpha", record));
+    CHECK(not visit_by_name(t, "alpha_.t1", record));
+    CHECK(not visit_by_name(t, "gamma_.t3", record));
+    CHECK(visited == "4");
+
+    CHECK(visit_by_name(t, std::string("gamma_.t1"), set_to_7()));
+    CHECK(visit_by_name(t, "beta_", set_to_7()));
+    CHECK((get<gamma_, t1>(t) == 7.0));
+    CHECK(get<beta_>(t) == 7.0);
+
+    const auto& ct = t;
+    sum_values sum;
+    CHECK(visit_by_name(ct, "gamma_.t2", sum));
+    CHECK(visit_by_name(ct, "alpha_", sum));
+    CHECK(sum.sum == 5);
+}
+
+TEST_CASE("Number parsing and formatting") {
+    auto parse = [](const char* s) {
+        double d = -1;
+        const char* end = s + strlen(s);
+        return parse_double(s, end, d) == end ? d : -1;
+    };
+    CHECK(parse("3.25") == 3.25);
+    CHECK(parse("-0.001") == -0.001);
+    CHECK(parse("1e10") == 1e10);
+    CHECK(parse("12345678901234567890123") == 12345678901234567890123.0);
+    CHECK(parse("4.9e-324") == 4.9e-324);
+    CHECK(parse(".") == -1);
+    CHECK(std::isinf(parse("1e99999999999")));  // exponents beyond int range do not overflow
+    CHECK(parse("1e-99999999999") == 0);
+    CHECK(parse("1e") == -1);
+
+    int i = 0;
+    const char* s = "-2147483648";
+    CHECK(parse_integer(s, s + 11, i) == s + 11);
+    CHECK(i == std::numeric_limits<int>::min());
+    s = "2147483648";
+    CHECK(parse_integer(s, s + 10, i) == nullptr);
+
+    char buffer[number_io_max_chars];
+    CHECK(std::string(buffer, write_double(buffer, 0.1)) == "0.10000000000000001");
+    CHECK(std::string(buffer, write_double(buffer, -12.0)) == "-12");
+    CHECK(std::string(buffer, write_integer(buffer, -9223372036854775807 - 1)) ==
+          "-9223372036854775808");
+
+    // non-finite values inside a longer document: only the token is parsed
+    double d = 0;
+    std::string document = "-inf," + std::string(200, ' ') + "nan";
+    CHECK(parse_double(&document[0], &document[0] + document.size(), d) == &document[4]);
+    CHECK(std::isinf(d));
+    CHECK(parse_double(&document[201], &document[0] + document.size(), d) == nullptr);
+    CHECK(parse_double(&document[205], &document[0] + document.size(), d) != nullptr);
+    CHECK(std::isnan(d));
+
+    // the locale does not change the decimal point (when a comma locale is installed)
+    for (const char* name : {"de_DE.UTF-8", "fr_FR.UTF-8", "de_DE", "fr_FR"}) {
+        if (std::setlocale(LC_NUMERIC, name) != nullptr) {
+            CHECK(std::string(buffer, write_double(buffer, 0.1)) == "0.10000000000000001");
+            CHECK(parse("1.5e300") == 1.5e300);
+            std::setlocale(LC_NUMERIC, "C");
+            break;
+        }
+    }
+}
+
+TEST_CASE("JSON encoding and decoding") {
+    auto inner = make_tagged_tuple(value_field<t1>(std::vector<int>{1, 2, 3}),
+                                   value_field<t2>(string("a \"quoted\"\n\\")));
+    auto t = make_tagged_tuple(value_field<alpha_>(-3), unique_ptr_field<beta_>(0.5),
+                               value_field<gamma_>(inner), value_field<delta_>(true));
+    std::string json = to_json(t);
+    CHECK(json ==
+          "{\"alpha_\":-3,\"beta_\":0.5,"
+          "\"gamma_\":{\"t1\":[1,2,3],\"t2\":\"a \\\"quoted\\\"\\n\\\\\"},"
+          "\"delta_\":true}");
+
+    auto u = make_tagged_tuple(value_field<alpha_>(0), unique_ptr_field<beta_>(0.0),
+                                value_field<gamma_>(inner), value_field<delta_>(false));
+    get<gamma_, t1>(u).clear();
+    get<gamma_, t2>(u) = "";
+    CHECK(from_json(u, json));
+    CHECK(to_json(u) == json);
+
+    // reordered keys, unknown keys, whitespace, escapes, missing fields
+    CHECK(from_json(u, R"( { "delta_" : false, "unknown": {"a": [1, "}", null]},
+                           "gamma_": {"t2": "\u00e9\ud83d\ude00"}, "alpha_": 1e2 } )") == false);
+    CHECK(from_json(u, R"( { "delta_" : false, "unknown": {"a": [1, "}", null]},
+                           "gamma_": {"t2": "\u00e9\ud83d\ude00"}, "alpha_": 100 } )"));
+    CHECK(get<alpha_>(u) == 100);
+    CHECK(get<beta_>(u) == 0.5);
+    CHECK(get<delta_>(u) == false);
+    CHECK((get<gamma_, t2>(u) == "\xc3\xa9\xf0\x9f\x98\x80"));
+    CHECK((get<gamma_, t1>(u) == std::vector<int>{1, 2, 3}));
+
+    CHECK(not from_json(u, "{\"alpha_\": 1"));
+    auto flags = make_tagged_tuple(value_field<alpha_>(std::vector<bool>{true, false, true}));
+    auto flags_copy = make_tagged_tuple(value_field<alpha_>(std::vector<bool>()));
+    CHECK(to_json(flags) == "{\"alpha_\":[true,false,true]}");
+    REQUIRE(from_json(flags_copy, to_json(flags)));
+    CHECK(get<alpha_>(flags_copy) == get<alpha_>(flags));
+    // deeply nested unknown values are rejected instead of exhausting the stack
+    std::string nested(100, '[');
+    CHECK(from_json(u, "{\"unknown\": " + nested + std::string(100, ']') + "}"));
+    std::string deep(100000, '[');
+    CHECK(not from_json(u, "{\"unknown\": " + deep + std::string(100000, ']') + "}"));
+    CHECK(not from_json(u, "{\"alpha_\": \"1\"}"));
+    CHECK(not from_json(u, "{\"alpha_\": 1} x"));
+}
+
+TEST_CASE("CSV loading") {
+    using row_t = tagged_tuple<no_metadata, field<alpha_, int>, field<beta_, double>,
+                               field<gamma_, std::string>, field<delta_, bool>>;
+    std::string data =
+        "gamma_,unknown,alpha_,beta_\r\n"
+        "\"a, \"\"b\"\"\",x,1,0.5\r\n"
+        "\n"
+        "c,y,-2,1e3\n"
+        "d,z,3,-0.25";
+    std::vector<row_t> rows;
+    CHECK(load_csv(data, rows));
+    REQUIRE(rows.size() == 3);
+    CHECK(get<gamma_>(rows[0]) == "a, \"b\"");
+    CHECK(get<alpha_>(rows[1]) == -2);
+    CHECK(get<beta_>(rows[1]) == 1000);
+    CHECK(get<beta_>(rows[2]) == -0.25);
+    CHECK(get<delta_>(rows[2]) == false);
+    CHECK(not load_csv("alpha_\n1.5\n", rows));
+    CHECK(not load_csv("alpha_,beta_\n7,1\n8,x\n", rows));
+    CHECK(rows.size() == 3);  // nothing from a failed load is kept
+
+    std::string tsv = "beta_\talpha_\n";
+    for (int i = 0; i < 1000; i++) {
+        tsv += std::to_string(i) + ".5\t" + std::to_string(i) + "\n";
+    }
+    auto columns = make_tagged_tuple(value_field<alpha_>(std::vector<int>()),
+                                     value_field<beta_>(std::vector<double>()),
+                                     value_field<gamma_>(std::vector<std::string>()));
+    CHECK(load_csv(tsv, columns, '\t', 4));
+    REQUIRE(get<alpha_>(columns).size() == 1000);
+    REQUIRE(get<gamma_>(columns).size() == 1000);
+    bool all_equal = true;
+    for (int i = 0; i < 1000; i++) {
+        all_equal = all_equal and get<alpha_>(columns)[i] == i and
+                    get<beta_>(columns)[i] == i + 0.5 and get<gamma_>(columns)[i].empty();
+    }
+    CHECK(all_equal);
+
+    std::vector<row_t> tsv_rows;
+    CHECK(load_csv(tsv, tsv_rows, '\t', 3));
+    CHECK(tsv_rows.size() == 1000);
+    CHECK(get<alpha_>(tsv_rows[999]) == 999);
+    CHECK(not load_csv("alpha_,beta_\n7,1\n8,x\n", columns));
+    CHECK(get<alpha_>(columns).size() == 1000);
+    CHECK(get<beta_>(columns).size() == 1000);
+}
+
+TEST_CASE("Hashing") {
+    using bitwise_t = tagged_tuple<no_metadata, field<alpha_, int>, field<beta_, unsigned>>;
+    using padded_t = tagged_tuple<no_metadata, field<alpha_, int>, field<beta_, char>>;
+    using nested_t = tagged_tuple<no_metadata, field<alpha_, bitwise_t>, field<beta_, int64_t>>;
+    CHECK(is_bitwise_comparable<bitwise_t>::value);
+    CHECK(is_bitwise_comparable<nested_t>::value);
+    CHECK(not is_bitwise_comparable<padded_t>::value);
+    CHECK(not is_bitwise_comparable<tagged_tuple<no_metadata, field<alpha_, double>>>::value);
+
+    bitwise_t a{tuple_construct(), 1, 2u}, b{tuple_construct(), 1, 2u}, c{tuple_construct(), 2, 1u};
+    std::hash<bitwise_t> h;
+    CHECK(h(a) == h(b));
+    CHECK(h(a) != h(c));
+
+    auto t1 = make_tagged_tuple(unique_ptr_field<alpha_>(2.5), value_field<beta_>(string("hi")),
+                                value_field<gamma_>(std::vector<int>{1, 2}));
+    auto t2 = make_tagged_tuple(unique_ptr_field<alpha_>(2.5), value_field<beta_>(string("hi")),
+                                value_field<gamma_>(std::vector<int>{1, 2}));
+    std::hash<decltype(t1)> h2;
+    CHECK(h2(t1) == h2(t2));  // pointer fields hashed by pointee
+    get<gamma_>(t2).push_back(3);
+    CHECK(h2(t1) != h2(t2));
+    CHECK(hash_bytes("abcdefghi", 9) != hash_bytes("abcdefghj", 9));
+}
+
+TEST_CASE("Comparison operators") {
+    using bitwise_t = tagged_tuple<no_metadata, field<alpha_, int>, field<beta_, unsigned>>;
+    bitwise_t a{tuple_construct(), 1, 2u}, b{tuple_construct(), 1, 2u}, c{tuple_construct(), 1, 3u};
+    CHECK(a == b);
+    CHECK(a != c);
+    CHECK(a < c);
+    CHECK(not(c < a));
+    CHECK(c >= a);
+
+    auto t1 = make_tagged_tuple(unique_ptr_field<alpha_>(2.5), value_field<beta_>(string("b")));
+    auto t2 = make_tagged_tuple(unique_ptr_field<alpha_>(2.5), value_field<beta_>(string("b")));
+    CHECK(t1 == t2);  // pointer fields compared by pointee
+    CHECK(not(t1.data == t2.data));
+    get<beta_>(t2) = "c";
+    CHECK(t1 != t2);
+    CHECK(t1 < t2);
+    get<alpha_>(t1) = 3.0;
+    CHECK(t2 < t1);
+    CHECK(t1 > t2);
+    CHECK(t2 <= t1);
+
+    auto n1 = make_tagged_tuple(value_field<gamma_>(a), value_field<delta_>(0.0));
+    auto n2 = make_tagged_tuple(value_field<gamma_>(b), value_field<delta_>(-0.0));
+    CHECK(n1 == n2);
+    get<gamma_, alpha_>(n2) = 0;
+    CHECK(n2 < n1);
+}
+
+TEST_CASE("Concurrent fields") {
+    using md = metadata<type_list<>, type_map<property<concurrent, type_list<alpha_, beta_>>>>;
+    auto t = make_tagged_tuple<md>(value_field<alpha_>(0), value_field<beta_>(0.5),
+                                   value_field<gamma_>(2));
+    CHECK(get<gamma_>(t) == 2);
+    CHECK(load<alpha_>(t) == 0);
+    CHECK((std::is_same<decltype(atomic_field<beta_>(t)), std::atomic<double>&>::value));
+
+    std::vector<std::thread> threads;
+    for (int i = 0; i < 4; i++) {
+        threads.emplace_back([&t]() {
+            for (int j = 0; j < 1000; j++) {
+                fetch_add<alpha_>(t, 1, std::memory_order_relaxed);
+                fetch_add<beta_>(t, 1);
+            }
+        });
+    }
+    for (auto& thread : threads) { thread.join(); }
+    CHECK(load<alpha_>(t) == 4000);
+    CHECK(load<beta_>(t, std::memory_order_acquire) == 4000.5);
+
+    store<beta_>(t, 10.0);
+    CHECK(fetch_sub<beta_>(t, 1u) == 10.0);  // argument of another type than the field
+    CHECK(load<beta_>(t) == 9.0);
+    store<alpha_>(t, 3);
+    CHECK(fetch_sub<alpha_>(t, 1) == 3);
+    int expected = 1;
+    CHECK(not compare_exchange_strong<alpha_>(t, expected, 5));
+    CHECK(expected == 2);
+    CHECK(compare_exchange_strong<alpha_>(t, expected, 5));
+    CHECK(exchange<alpha_>(t, 6) == 5);
+
+    auto copy = t;
+    CHECK(load<alpha_>(copy) == 6);
+}
+
+TEST_CASE("Seqlocked snapshots") {
+    using state_t = tagged_tuple<no_metadata, field<alpha_, int64_t>, field<beta_, double>,
+                                 field<gamma_, int64_t>>;
+    seqlocked<state_t> state(state_t{tuple_construct(), 0, 0.0, 0});
+    std::atomic<bool> done{false};
+    std::thread writer([&]() {
+        for (int64_t i = 1; i <= 20000; i++) {
+            state.write([i](state_t& t) {
+                get<alpha_>(t) = i;
+                get<beta_>(t) = 0.5 * i;
+                get<gamma_>(t) = -i;
+            });
+        }
+        done = true;
+    });
+    bool consistent = true;
+    int64_t last = 0;
+    while (not done) {
+        auto snapshot = state.read_snapshot();
+        consistent = consistent and get<gamma_>(snapshot) == -get<alpha_>(snapshot) and
+                     get<beta_>(snapshot) == 0.5 * get<alpha_>(snapshot) and
+                     get<alpha_>(snapshot) >= last;
+        last = get<alpha_>(snapshot);
+    }
+    writer.join();
+    CHECK(consistent);
+    CHECK(get<alpha_>(state.read_snapshot()) == 20000);
+    CHECK(state.version() == 20000);
+}
+
+TEST_CASE("Published double/triple buffering") {
+    using state_t = tagged_tuple<no_metadata, field<alpha_, int>, field<beta_, std::vector<int>>>;
+    published<state_t> state(state_t{tuple_construct(), 0, std::vector<int>(100, 0)});
+    std::atomic<bool> done{false};
+    auto reader = [&]() {
+        bool consistent = true;
+        int last = 0;
+        while (not done) {
+            auto guard = state.read();
+            int version = get<alpha_>(*guard);
+            for (int x : get<beta_>(*guard)) { consistent = consistent and x == version; }
+            consistent = consistent and version >= last;
+            last = version;
+        }
+        return consistent;
+    };
+    bool consistent1 = false, consistent2 = false;
+    std::thread r1([&]() { consistent1 = reader(); });
+    std::thread r2([&]() { consistent2 = reader(); });
+    for (int i = 1; i <= 5000; i++) {
+        auto& next = state.back();
+        get<alpha_>(next) = i;
+        for (int& x : get<beta_>(next)) { x = i; }
+        state.publish();
+    }
+    done = true;
+    r1.join();
+    r2.join();
+    CHECK(consistent1);
+    CHECK(consistent2);
+    CHECK(state.epoch() == 5000);
+    CHECK(get<alpha_>(*state.read()) == 5000);
+}
+
+TEST_CASE("Cache line isolation") {
+    using md = metadata<type_list<>,
+                        type_map<property<cache_line_isolated, type_list<beta_, gamma_>>,
+                                 property<concurrent, type_list<gamma_>>>>;
+    auto t = make_tagged_tuple<md>(value_field<alpha_>(1), value_field<beta_>(2.0),
+                                   value_field<gamma_>(3), unique_ptr_field<delta_>(4));
+    CHECK(get<alpha_>(t) == 1);
+    CHECK(get<beta_>(t) == 2.0);
+    CHECK(load<gamma_>(t) == 3);
+    CHECK(get<delta_>(t) == 4);
+    get<beta_>(t) = 2.5;
+    CHECK(get<beta_>(t) == 2.5);
+    CHECK(alignof(decltype(t)) == cache_line_size);
+
+    static_assert(is_cache_line_isolated<beta_, decltype(t)>::value, "");
+    static_assert(not is_cache_line_isolated<alpha_, decltype(t)>::value, "");
+    constexpr auto isolated = isolated_fields<decltype(t)>();
+    static_assert(not isolated[0] and isolated[1] and isolated[2] and not isolated[3], "");
+
+    auto report = cache_line_report(t);
+    REQUIRE(report.size() == 4);
+    CHECK(report[1].name == "beta_");
+    CHECK(report[1].offset % cache_line_size == 0);
+    CHECK(report[1].shares_line_with.empty());
+    CHECK(report[2].shares_line_with.empty());
+    for (auto& name : report[0].shares_line_with) { CHECK(name == "delta_"); }
+
+    // compile-time view for standard_layout tuples
+    using layout_md = metadata<type_list<standard_layout>,
+                               type_map<property<cache_line_isolated, type_list<beta_>>>>;
+    using layout_t = tagged_tuple<layout_md, field<alpha_, int>, field<beta_, double>,
+                                  field<gamma_, int>, field<delta_, char>>;
+    static_assert(not may_share_cache_line<layout_t, alpha_, beta_>(), "");
+    static_assert(not may_share_cache_line<layout_t, gamma_, beta_>(), "");
+    static_assert(may_share_cache_line<layout_t, gamma_, delta_>(), "");
+    using packed_t = tagged_tuple<metadata<type_list<standard_layout>, type_map<>>,
+                                  field<alpha_, char>, field<beta_, std::array<char, 100>>,
+                                  field<gamma_, char>>;
+    static_assert(may_share_cache_line<packed_t, alpha_, beta_>(), "");
+    static_assert(not may_share_cache_line<packed_t, alpha_, gamma_>(), "");
+}
+
+TEST_CASE("Access counting") {
+    using md = metadata<type_list<count_accesses>, type_map<>>;
+    auto inner = make_tagged_tuple(value_field<alpha_>(1));
+    auto t = make_tagged_tuple<md>(value_field<alpha_>(1), value_field<beta_>(inner));
+    using tuple_t = decltype(t);
+    reset_access_counts();
+    std::vector<std::thread> threads;
+    for (int i = 0; i < 3; i++) {
+        threads.emplace_back([&t]() {
+            int sum = 0;
+            for (int j = 0; j < 100; j++) { sum += get<alpha_>(t) + get<beta_, alpha_>(t); }
+            for (int j = 0; j < 50; j++) { sum += get<alpha_>(static_cast<const tuple_t&>(t)); }
+            CHECK(sum == 250);
+        });
+    }
+    for (auto& thread : threads) { thread.join(); }
+    CHECK(access_count_of<tuple_t, alpha_>() == 450);
+    CHECK(access_count_of<tuple_t, beta_>() == 300);
+
+    auto report = access_report();
+    REQUIRE(report.size() >= 2);
+    CHECK(report[0].tag_name == "alpha_");
+    CHECK(report[0].count == 450);
+    CHECK(report[1].tag_name == "beta_");
+    CHECK(report[1].tuple_name == type_name<tuple_t>());
+
+    // counters of exited threads are reused: one per concurrent thread, counts kept
+    for (int i = 0; i < 20; i++) {
+        std::thread([&t]() { CHECK(get<alpha_>(t) == 1); }).join();
+    }
+    CHECK(access_count_of<tuple_t, alpha_>() == 470);
+    size_t nb_nodes = 0;
+    auto node = helper::access_counter_of<tuple_t, alpha_>().nodes.load();
+    for (; node != nullptr; node = node->next) { nb_nodes++; }
+    CHECK(nb_nodes <= 4);
+}
+
+TEST_CASE("basic type printing") { CHECK(type_to_string<alpha_>() == "alpha_"); }
+
+TEST_CASE("struct printing") {
+    using tuple_t = tagged_tuple<no_metadata, field<alpha_, int>, field<beta_, double>>;
+    tuple_t t;
+    t.data = std::make_tuple(1, 3.2);
+    constexpr const_string debug = type_to_string<tuple_t>();
+    static_assert(debug.size() == 42, "");
+    CHECK(type_to_string(t) == "tagged_tuple { int alpha_; double beta_; }");
+}
+
+TEST_CASE("Struct printing with non-default constructible stuff") {
+    double a = 3.2;
+    auto inner = make_tagged_tuple(ref_field<alpha_>(a));
+    auto outer = make_tagged_tuple(value_field<beta_>(inner));
+    CHECK(type_to_string(outer) == "tagged_tuple { tagged_tuple { double& alpha_; } beta_; }");
+}
+
+TEST_CASE("Struct printing with unique_pointers") {
+    auto t = make_tagged_tuple(unique_ptr_field<alpha_>(3.2));
+    CHECK(type_to_string(t) == "tagged_tuple { unique_ptr<double> alpha_; }");
+}
+
+TEST_CASE("recursive struct printing") {
+    using tuple_t = tagged_tuple<no_metadata, field<alpha_, int>, field<beta_, double>>;
+    using tuple2_t = tagged_tuple<no_metadata, field<alpha_, tuple_t>, field<beta_, tuple_t>>;
+    tuple2_t t;
+    get<alpha_>(t).data = std::make_tuple(2, 3.9);
+    get<beta_>(t).data = std::make_tuple(0, 3.2);
+    CHECK(type_to_string(t) ==
+          "tagged_tuple { tagged_tuple { int alpha_; double beta_; } alpha_; tagged_tuple { int "
+          "alpha_; double beta_; } beta_; }");
+}
+
+TEST_CASE("Memory report") {
+    using inner_t = tagged_tuple<no_metadata, field<alpha_, char>, field<beta_, std::vector<int>>>;
+    using outer_t = tagged_tuple<no_metadata, field<alpha_, std::unique_ptr<double>>,
+                                 field<beta_, inner_t>, field<gamma_, std::string>>;
+    outer_t t;
+    std::get<0>(t.data) = std::make_unique<double>(2.0);
+    get<beta_, beta_>(t).reserve(10);
+    get<gamma_>(t) = std::string(100, 'a');
+
+    auto report = memory_report(t);
+    REQUIRE(report.size() == 5);
+    CHECK(report[0].path == "alpha_");
+    CHECK(report[0].size == sizeof(std::unique_ptr<double>));
+    CHECK(report[0].heap_bytes == sizeof(double));
+    CHECK(report[1].path == "beta_");
+    CHECK(report[1].depth == 0);
+    CHECK(report[1].size == sizeof(inner_t));
+    CHECK(report[1].heap_bytes == 10 * sizeof(int));
+    CHECK(report[2].path == "beta_.alpha_");
+    CHECK(report[2].depth == 1);
+    CHECK(report[2].size == 1);
+    CHECK(report[2].padding + report[3].padding == sizeof(inner_t) - 1 - sizeof(std::vector<int>));
+    CHECK(report[3].path == "beta_.beta_");
+    CHECK(report[3].alignment == alignof(std::vector<int>));
+    CHECK(report[4].path == "gamma_");
+    CHECK(report[4].heap_bytes >= 101);
+    CHECK(total_bytes(report) == sizeof(t) + report[0].heap_bytes + report[1].heap_bytes +
+                                     report[4].heap_bytes);
+
+    std::vector<outer_t> v(3);
+    get<beta_, beta_>(v[1]).reserve(5);
+    auto aggregate = memory_report(v);
+    REQUIRE(aggregate.size() == 5);
+    CHECK(aggregate[1].count == 3);
+    CHECK(aggregate[1].size == 3 * sizeof(inner_t));
+    CHECK(aggregate[3].heap_bytes == 5 * sizeof(int));
+}
+
+TEST_CASE("Standard layout storage") {
+    using md = metadata<type_list<standard_layout>, type_map<>>;
+    using tuple_t = tagged_tuple<md, field<alpha_, char>, field<beta_, double>, field<gamma_, int>,
+                                 field<delta_, std::vector<int>>>;
+    static_assert(std::is_standard_layout<tuple_t>::value, "");
+    struct reference_t {
+        char alpha;
+        double beta;
+        int gamma;
+        std::vector<int> delta;
+    };
+    static_assert(sizeof(tuple_t) == sizeof(reference_t), "");
+    static_assert(offset_of<alpha_, tuple_t>() == offsetof(reference_t, alpha), "");
+    static_assert(offset_of<beta_, tuple_t>() == offsetof(reference_t, beta), "");
+    static_assert(offset_of<gamma_, tuple_t>() == offsetof(reference_t, gamma), "");
+    static_assert(offset_of<delta_, tuple_t>() == offsetof(reference_t, delta), "");
+    constexpr auto sizes = field_sizes<tuple_t>();
+    static_assert(sizes[1] == sizeof(double) and sizes[3] == sizeof(std::vector<int>), "");
+
+    tuple_t t;
+    CHECK(get<alpha_>(t) == 0);
+    get<alpha_>(t) = 'a';
+    get<beta_>(t) = 2.5;
+    get<gamma_>(t) = 17;
+    get<delta_>(t) = {1, 2, 3};
+    auto bytes = reinterpret_cast<const char*>(&t);
+    CHECK(*reinterpret_cast<const double*>(bytes + offset_of<beta_, tuple_t>()) == 2.5);
+    CHECK(*reinterpret_cast<const int*>(bytes + offset_of<gamma_, tuple_t>()) == 17);
+
+    auto copy = t;
+    get<delta_>(t).push_back(4);
+    CHECK(get<delta_>(copy).size() == 3);
+    auto moved = std::move(t);
+    CHECK(get<delta_>(moved).size() == 4);
+    CHECK(get<alpha_>(moved) == 'a');
+
+    double x = 1.0;
+    auto r = make_tagged_tuple<md>(ref_field<alpha_>(x), value_field<beta_>(2));
+    constexpr auto ref_sizes = field_sizes<decltype(r)>();
+    static_assert(ref_sizes[0] == sizeof(double*), "");
+    get<alpha_>(r) = 3.0;
+    CHECK(x == 3.0);
+    CHECK(get<beta_>(r) == 2);
+}
+
+TEST_CASE("Standard layout storage with throwing fields") {
+    struct tracked {
+        static int& nb_alive() {
+            static int n = 0;
+            return n;
+        }
+        tracked() { nb_alive()++; }
+        tracked(const tracked&) { nb_alive()++; }
+        ~tracked() { nb_alive()--; }
+    };
+    struct thrower {
+        static bool& armed() {
+            static bool b = false;
+            return b;
+        }
+        thrower() {
+            if (armed()) { throw 1; }
+        }
+        thrower(const thrower&) { throw 2; }
+    };
+    using md = metadata<type_list<standard_layout>, type_map<>>;
+    using tuple_t = tagged_tuple<md, field<alpha_, tracked>, field<beta_, thrower>>;
+    {
+        tuple_t t;
+        CHECK(tracked::nb_alive() == 1);
+        CHECK_THROWS(tuple_t{t});  // copy
+        CHECK(tracked::nb_alive() == 1);
+        CHECK_THROWS(tuple_t(std::move(t)));  // thrower has no move constructor: copied
+        CHECK(tracked::nb_alive() == 1);
+        thrower::armed() = true;
+        CHECK_THROWS(tuple_t());
+        CHECK(tracked::nb_alive() == 1);
+        CHECK_THROWS(make_tagged_tuple<md>(value_field<alpha_>(tracked()),
+                                           value_field<beta_>(thrower())));
+        thrower::armed() = false;
+        CHECK_THROWS(make_tagged_tuple<md>(value_field<alpha_>(tracked()),
+                                           move_field<beta_>(get<beta_>(t))));
+        CHECK(tracked::nb_alive() == 1);
+    }
+    CHECK(tracked::nb_alive() == 0);
+}
+
+TEST_CASE("Tagged variant") {
+    struct counting {
+        static int& nb_alive() {
+            static int n = 0;
+            return n;
+        }
+        std::vector<int> values;
+        counting(std::vector<int> values) : values(values) { nb_alive()++; }
+        counting(const counting& other) : values(other.values) { nb_alive()++; }
+        ~counting() { nb_alive()--; }
+    };
+    using variant_t =
+        tagged_variant<field<alpha_, int>, field<beta_, double>, field<gamma_, counting>>;
+    struct size_visitor {
+        size_t operator()(int) const { return 1; }
+        size_t operator()(double) const { return 2; }
+        size_t operator()(const counting& c) const { return c.values.size(); }
+    };
+
+    variant_t v;
+    CHECK(holds<alpha_>(v));
+    CHECK(get<alpha_>(v) == 0);
+    CHECK(get_if<beta_>(v) == nullptr);
+    v.emplace<beta_>(3.5);
+    CHECK(v.index() == 1);
+    REQUIRE(get_if<beta_>(v) != nullptr);
+    CHECK(*get_if<beta_>(v) == 3.5);
+    CHECK(visit(v, size_visitor()) == 2);
+
+    v.emplace<gamma_>(std::vector<int>{1, 2, 3});
+    CHECK(counting::nb_alive() == 1);
+    CHECK(visit(v, size_visitor()) == 3);
+    {
+        const variant_t copy = v;
+        CHECK(counting::nb_alive() == 2);
+        CHECK(get<gamma_>(copy).values.size() == 3);
+        CHECK(visit(copy, size_visitor()) == 3);
+    }
+    CHECK(counting::nb_alive() == 1);
+    v = make_tagged_variant<variant_t, alpha_>(7);
+    CHECK(counting::nb_alive() == 0);
+    CHECK(get<alpha_>(v) == 7);
+    struct increment {
+        void operator()(int& x) const { x++; }
+        void operator()(double& x) const { x++; }
+        void operator()(counting& c) const { c.values.push_back(0); }
+    };
+    visit(v, increment());
+    CHECK(get<alpha_>(v) == 8);
+}
+
+TEST_CASE("Ensemble") {
+    auto inner = make_tagged_tuple(value_field<alpha_>(1.0), value_field<beta_>(2));
+    auto model = make_tagged_tuple(value_field<alpha_>(inner), unique_ptr_field<beta_>(0.5),
+                                   value_field<gamma_>(std::vector<int>{1, 2}));
+    ensemble<decltype(model)> chains(4, model);
+    CHECK(chains.size() == 4);
+    CHECK(get<alpha_, alpha_>(chains).size() == 4);
+    CHECK(get<beta_>(chains) == std::vector<double>(4, 0.5));
+
+    for (size_t i = 0; i < 4; i++) {
+        get<alpha_, alpha_>(chains)[i] = double(i);
+        get<beta_>(chains)[i] = 10.0 * i;
+    }
+    CHECK(mean<alpha_, alpha_>(chains) == 1.5);
+    CHECK(mean<beta_>(chains) == 15.0);
+
+    chains.swap_replicas(0, 3);
+    CHECK(get<alpha_, alpha_>(chains)[0] == 3.0);
+    CHECK(get<alpha_, alpha_>(chains)[3] == 0.0);
+    CHECK(get<beta_>(chains)[0] == 30.0);
+
+    chains.extract(0, model);
+    CHECK(get<alpha_, alpha_>(model) == 3.0);
+    CHECK(get<beta_>(model) == 30.0);
+    get<gamma_>(model).push_back(3);
+    chains.store(1, model);
+    CHECK(get<gamma_>(chains)[1].size() == 3);
+    CHECK(get<beta_>(chains)[1] == 30.0);
+
+    broadcast<beta_>(chains, 1.0);
+    CHECK(mean<beta_>(chains) == 1.0);
+    broadcast<beta_>(chains, 2);
+    CHECK(mean<beta_>(chains) == 2.0);
+    broadcast<alpha_, alpha_>(chains, 5);
+    CHECK(get<alpha_, alpha_>(chains)[3] == 5.0);
+    broadcast<alpha_>(chains, inner);
+    CHECK(get<alpha_, beta_>(chains) == std::vector<int>(4, 2));
+}
+
+TEST_CASE("Work-stealing parallel algorithms") {
+    using site_t = tagged_tuple<no_metadata, field<alpha_, int>, field<beta_, double>>;
+    std::vector<site_t> sites(10000);
+    for (size_t i = 0; i < sites.size(); i++) { get<alpha_>(sites[i]) = int(i); }
+
+    work_stealing_pool pool(3);
+    CHECK(pool.nb_workers() == 4);
+    // uneven costs: the first sites are much more expensive
+    parallel_for_each(
+        sites,
+        [](site_t& site) {
+            double x = 0;
+            int n = get<alpha_>(site) < 100 ? 10000 : 1;
+            for (int i = 0; i < n; i++) { x += 1.0 / n; }
+            get<beta_>(site) = x * get<alpha_>(site);
+        },
+        pool);
+    CHECK(get<beta_>(sites[7]) == doctest::Approx(7));
+    CHECK(get<beta_>(sites[9999]) == 9999);
+
+    std::vector<int> doubled;
+    parallel_transform(sites, doubled, [](const site_t& site) { return 2 * get<alpha_>(site); },
+                       pool);
+    REQUIRE(doubled.size() == sites.size());
+    CHECK(doubled[1234] == 2468);
+
+    auto sum = parallel_reduce(
+        sites, int64_t(0), [](const site_t& site) { return int64_t(get<alpha_>(site)); },
+        std::plus<int64_t>(), pool);
+    CHECK(sum == int64_t(9999) * 10000 / 2);
+
+    auto max = [](int a, int b) { return a > b ? a : b; };
+    auto init = make_tagged_tuple(value_field<alpha_>(0), value_field<beta_>(0.0));
+    auto combiners =
+        make_tagged_tuple(value_field<alpha_>(max), value_field<beta_>(std::plus<double>()));
+    auto result = parallel_reduce_fields(sites, init, combiners, pool);
+    CHECK(get<alpha_>(result) == 9999);
+    CHECK(get<beta_>(result) == doctest::Approx(9999.0 * 10000 / 2));
+
+    // bool results, packed in bits by std::vector<bool>
+    std::vector<bool> odd;
+    parallel_transform(sites, odd, [](const site_t& site) { return get<alpha_>(site) % 2 == 1; },
+                       pool);
+    REQUIRE(odd.size() == sites.size());
+    size_t nb_correct = 0;
+    for (size_t i = 0; i < odd.size(); i++) { nb_correct += odd[i] == (i % 2 == 1) ? 1 : 0; }
+    CHECK(nb_correct == sites.size());
+    CHECK(parallel_reduce(
+        sites, false, [](const site_t& site) { return get<alpha_>(site) == 5000; },
+        [](bool a, bool b) { return a or b; }, pool));
+
+    // counting elements needs a separate merge step
+    auto count = [](int n, int) { return n + 1; };
+    auto counters =
+        make_tagged_tuple(value_field<alpha_>(count), value_field<beta_>(std::plus<double>()));
+    auto mergers = make_tagged_tuple(value_field<alpha_>(std::plus<int>()),
+                                     value_field<beta_>(std::plus<double>()));
+    auto counted = parallel_reduce_fields(sites, init, counters, mergers, pool);
+    CHECK(get<alpha_>(counted) == 10000);
+    CHECK(get<beta_>(counted) == doctest::Approx(9999.0 * 10000 / 2));
+
+    // exceptions thrown by loop bodies reach the caller, and the pool stays usable
+    CHECK_THROWS_AS(parallel_for_each(
+                        sites,
+                        [](site_t& site) {
+                            if (get<alpha_>(site) % 1000 == 999) {
+                                throw std::runtime_error("body");
+                            }
+                        },
+                        pool),
+                    std::runtime_error);
+    CHECK(parallel_reduce(
+              sites, int64_t(0), [](const site_t& site) { return int64_t(get<alpha_>(site)); },
+              std::plus<int64_t>(), pool) == int64_t(9999) * 10000 / 2);
+
+    // default pool, empty collection
+    std::vector<site_t> empty;
+    CHECK(parallel_reduce(
+              empty, 0, [](const site_t& site) { return get<alpha_>(site); },
+              std::plus<int>()) == 0);
+}
+
+TEST_CASE("Asynchronous construction") {
+    // each factory waits until all of them have started: only succeeds if they run concurrently
+    std::atomic<int> nb_started{0};
+    auto wait_for_others = [&nb_started]() {
+        nb_started++;
+        while (nb_started.load() < 3) { std::this_thread::yield(); }
+    };
+    auto future = make_tagged_tuple_async(
+        thread_executor(),
+        deferred_field<alpha_>([=]() {
+            wait_for_others();
+            return std::vector<int>(1000, 1);
+        }),
+        deferred_field<beta_>([=]() {
+            wait_for_others();
+            return std::make_unique<double>(2.5);
+        }),
+        value_field<gamma_>(3),
+        deferred_field<delta_>([=]() {
+            wait_for_others();
+            return std::string("delta");
+        }));
+    auto t = future.get();
+    CHECK(get<alpha_>(t).size() == 1000);
+    CHECK(get<beta_>(t) == 2.5);
+    CHECK(get<gamma_>(t) == 3);
+    CHECK(get<delta_>(t) == "delta");
+
+    auto ready = make_tagged_tuple_async(inline_executor(), value_field<alpha_>(1),
+                                         deferred_field<beta_>([]() { return 2.0; }));
+    CHECK(ready.wait_for(std::chrono::seconds(0)) == std::future_status::ready);
+    CHECK(get<beta_>(ready.get()) == 2.0);
+
+    // a throwing factory is reported through the future
+    auto failed = make_tagged_tuple_async(
+        thread_executor(), deferred_field<alpha_>([]() { return 1; }),
+        deferred_field<beta_>([]() -> double { throw std::runtime_error("factory"); }));
+    CHECK_THROWS_AS(failed.get(), std::runtime_error);
+}
+
+TEST_CASE("Copy-on-write fields") {
+    auto t = make_tagged_tuple(cow_field<alpha_>(std::vector<double>(1000, 1.0)),
+                               value_field<beta_>(2));
+    auto copy = t;
+    const auto& const_t = t;
+    const auto& const_copy = copy;
+    CHECK(&get<alpha_>(const_t) == &get<alpha_>(const_copy));
+    CHECK(std::get<0>(t.data).use_count() == 2);
+
+    get<alpha_>(copy)[0] = 5.0;  // clones
+    CHECK(std::get<0>(t.data).use_count() == 1);
+    CHECK(std::get<0>(copy.data).use_count() == 1);
+    CHECK(get<alpha_>(const_t)[0] == 1.0);
+    CHECK(get<alpha_>(const_copy)[0] == 5.0);
+    auto address = &get<alpha_>(const_copy);
+    get<alpha_>(copy)[1] = 6.0;  // not shared anymore: no clone
+    CHECK(&get<alpha_>(const_copy) == address);
+
+    copy = t;
+    CHECK(std::get<0>(t.data).use_count() == 2);
+    CHECK(get<alpha_>(const_copy)[0] == 1.0);
+    auto moved = std::move(copy);
+    CHECK(std::get<0>(t.data).use_count() == 2);
+    cow_ptr<int> p(3);
+    cow_ptr<int> p2(p);
+    CHECK(p2.use_count() == 2);
+}
+
+TEST_CASE("Shared fields") {
+    auto submodel = shared_value<std::vector<int>>(3, 1);
+    auto t1 = make_tagged_tuple(shared_field<alpha_>(submodel), value_field<beta_>(1));
+    auto t2 = make_tagged_tuple(shared_field<alpha_>(submodel), shared_field<beta_>(2.5));
+    CHECK(submodel.use_count() == 3);
+    get<alpha_>(t1).push_back(2);
+    CHECK(get<alpha_>(t2).size() == 4);
+    CHECK(get<beta_>(t2) == 2.5);
+    {
+        auto copy = t2;
+        CHECK(submodel.use_count() == 4);
+        get<beta_>(copy) = 3.5;
+        CHECK(get<beta_>(t2) == 3.5);
+    }
+    CHECK(submodel.use_count() == 3);
+
+    auto local = local_shared_value<std::string>("shared");
+    auto u = make_tagged_tuple(local_shared_field<alpha_>(local), local_shared_field<beta_>(1));
+    static_assert(sizeof(local) == sizeof(void*), "");
+    CHECK(local.use_count() == 2);
+    get<alpha_>(u) += " string";
+    CHECK(local.get() == "shared string");
+    auto moved = std::move(u);
+    CHECK(local.use_count() == 2);
+    u = moved;
+    CHECK(local.use_count() == 3);
+
+    // rvalue handles are moved into the field, not wrapped in another shared value
+    auto v = make_tagged_tuple(shared_field<alpha_>(shared_value<int>(4)),
+                               local_shared_field<beta_>(std::move(local)));
+    static_assert(std::is_same<std::tuple_element_t<0, decltype(v.data)>,
+                               shared_value<int>>::value,
+                  "");
+    CHECK(get<alpha_>(v) == 4);
+    CHECK(std::get<1>(v.data).use_count() == 3);
+    CHECK(local.use_count() == 0);
+}
+
+TEST_CASE("Pooled unique_ptr fields") {
+    using md = metadata<type_list<>, type_map<property<pooled, type_list<alpha_>>>>;
+    auto make = [](double x) {
+        return make_tagged_tuple<md>(unique_ptr_field<alpha_>(x), unique_ptr_field<beta_>(2 * x));
+    };
+    using tuple_t = decltype(make(0));
+    static_assert(std::is_same<std::tuple_element_t<0, decltype(tuple_t::data)>,
+                               pooled_ptr<double>>::value,
+                  "");
+    static_assert(std::is_same<std::tuple_element_t<1, decltype(tuple_t::data)>,
+                               std::unique_ptr<double>>::value,
+                  "");
+
+    size_t nb_free = object_pool<double>::nb_free();
+    const double* address;
+    {
+        auto t = make(1.5);
+        CHECK(get<alpha_>(t) == 1.5);
+        CHECK(get<beta_>(t) == 3.0);
+        get<alpha_>(t) = 2.5;
+        auto moved = std::move(t);
+        CHECK(get<alpha_>(moved) == 2.5);
+        address = &get<alpha_>(moved);
+    }
+    CHECK(object_pool<double>::nb_free() == nb_free + 1);
+    auto t = make(4.0);  // recycled block
+    CHECK(&get<alpha_>(t) == address);
+    CHECK(object_pool<double>::nb_free() == nb_free);
+
+    auto p = make_pooled<std::vector<int>>(3, 7);
+    CHECK(p->size() == 3);
+    pooled_ptr<std::vector<int>> q(std::make_unique<std::vector<int>>(2, 1));
+    CHECK((*q)[1] == 1);
+
+    // the block of a value whose constructor throws is given back
+    struct thrower {
+        explicit thrower(int) { throw 1; }
+    };
+    size_t nb_free_throwers = object_pool<thrower>::nb_free();
+    CHECK_THROWS(make_pooled<thrower>(0));
+    CHECK(object_pool<thrower>::nb_free() == nb_free_throwers + 1);
+
+    // unique_ptr fields in asynchronous construction, pooled or not
+    auto future = make_tagged_tuple_async<md>(
+        inline_executor(), unique_ptr_field<alpha_>(5.0),
+        unique_ptr_field<beta_>(std::vector<int>(100, 3)),
+        deferred_field<gamma_>([]() { return std::string("gamma"); }));
+    auto u = future.get();
+    static_assert(std::is_same<std::tuple_element_t<0, decltype(u.data)>,
+                               pooled_ptr<double>>::value,
+                  "");
+    CHECK(get<alpha_>(u) == 5.0);
+    CHECK(get<beta_>(u).size() == 100);
+    CHECK(get<beta_>(u)[99] == 3);
+    CHECK(get<gamma_>(u) == "gamma");
+}
+
+TEST_CASE("Dynamic tagged tuple") {
+    auto schema = std::make_shared<dynamic_schema>();
+    schema->add<char>("alpha_").add<double>("beta_").add<std::vector<int>>("gamma_");
+    CHECK(schema->nb_fields() == 3);
+    CHECK(schema->field(1).offset == 8);
+    int beta = schema->index_of("beta_");
+    int gamma = schema->index_of("gamma_");
+    CHECK(schema->index_of("delta_") == -1);
+
+    dynamic_tagged_tuple t(schema);
+    CHECK(get<double>(t, beta) == 0.0);
+    get<double>(t, beta) = 2.5;
+    get<std::vector<int>>(t, gamma) = {1, 2, 3};
+    auto copy = t;
+    get<std::vector<int>>(t, gamma).push_back(4);
+    CHECK(get<std::vector<int>>(copy, gamma).size() == 3);
+
+    // dynamic -> static
+    using md = metadata<type_list<standard_layout>, type_map<>>;
+    using static_t = tagged_tuple<md, field<alpha_, char>, field<beta_, double>,
+                                  field<gamma_, std::vector<int>>>;
+    static_t* s = static_view<static_t>(t);
+    REQUIRE(s != nullptr);
+    CHECK(get<beta_>(*s) == 2.5);
+    CHECK(get<gamma_>(*s).size() == 4);
+    get<alpha_>(*s) = 'z';
+    CHECK(get<char>(t, 0) == 'z');
+    using other_t = tagged_tuple<md, field<alpha_, char>, field<beta_, float>,
+                                 field<gamma_, std::vector<int>>>;
+    CHECK(static_view<other_t>(t) == nullptr);
+
+    // static -> dynamic
+    static_t u;
+    get<beta_>(u) = 1.5;
+    auto view = dynamic_view(u);
+    CHECK(view.is_view());
+    CHECK(view.schema().compatible_with(*schema));
+    CHECK(get<double>(view, beta) == 1.5);
+    get<std::vector<int>>(view, gamma).push_back(1);
+    CHECK(get<gamma_>(u).size() == 1);
+
+    // exact type identity: types with the same stable hash are still different types
+    static_assert(type_id<long>() != type_id<long long>(), "");
+    using shared_t = tagged_tuple<md, field<alpha_, shared_value<double>>>;
+    using local_t = tagged_tuple<md, field<alpha_, local_shared_value<double>>>;
+    shared_t sh(tuple_construct(), shared_value<double>(1.0));
+    auto shared_view = dynamic_view(sh);
+    CHECK(static_view<local_t>(shared_view) == nullptr);
+    CHECK(static_view<shared_t>(shared_view) == &sh);
+
+    // views of tuples with non-copyable fields; copies of them throw
+    using owning_t = tagged_tuple<md, field<alpha_, std::unique_ptr<int>>, field<beta_, int>>;
+    owning_t o;
+    get<beta_>(o) = 3;
+    auto owning_view = dynamic_view(o);
+    CHECK(get<int>(owning_view, 1) == 3);
+    CHECK_THROWS_AS(dynamic_tagged_tuple{owning_view}, std::logic_error);
+}
+
+TEST_CASE("Dynamic tagged tuple with throwing fields") {
+    struct tracked {
+        static int& nb_alive() {
+            static int n = 0;
+            return n;
+        }
+        tracked() { nb_alive()++; }
+        tracked(const tracked&) { nb_alive()++; }
+        ~tracked() { nb_alive()--; }
+    };
+    struct thrower {
+        static bool& armed() {
+            static bool b = false;
+            return b;
+        }
+        thrower() {
+            if (armed()) { throw 1; }
+        }
+        thrower(const thrower&) { throw 2; }
+    };
+    auto schema = std::make_shared<dynamic_schema>();
+    schema->add<tracked>("alpha_").add<tracked>("beta_").add<thrower>("gamma_");
+    {
+        dynamic_tagged_tuple t(schema);
+        CHECK(tracked::nb_alive() == 2);
+        CHECK_THROWS(dynamic_tagged_tuple{t});  // the copies of alpha_ and beta_ are destroyed
+        CHECK(tracked::nb_alive() == 2);
+        thrower::armed() = true;
+        CHECK_THROWS(dynamic_tagged_tuple{schema});
+        CHECK(tracked::nb_alive() == 2);
+        thrower::armed() = false;
+
+        const void* data = t.data();
+        dynamic_tagged_tuple moved(std::move(t));
+        CHECK(moved.data() == data);
+        CHECK(t.data() == nullptr);
+        CHECK(tracked::nb_alive() == 2);
+    }
+    CHECK(tracked::nb_alive() == 0);
+}
+
+TEST_CASE("Binary serialization with schema evolution") {
+    using raw_t = tagged_tuple<no_metadata, field<alpha_, int>, field<beta_, double>>;
+    raw_t r;
+    get<alpha_>(r) = 3;
+    get<beta_>(r) = 1.5;
+    raw_t r2;
+    REQUIRE(from_binary(r2, to_binary(r)));
+    CHECK(r2 == r);
+
+    using inner_v1 = tagged_tuple<no_metadata, field<alpha_, int>, field<beta_, std::string>>;
+    using v1_t = tagged_tuple<no_metadata, field<alpha_, int>, field<beta_, double>,
+                              field<gamma_, std::string>, field<delta_, inner_v1>>;
+    v1_t v1;
+    get<alpha_>(v1) = 7;
+    get<beta_>(v1) = 2.5;
+    get<gamma_>(v1) = "chain 1";
+    get<delta_, alpha_>(v1) = 11;
+    get<delta_, beta_>(v1) = "inner";
+    auto data = to_binary(v1);
+
+    v1_t same;
+    REQUIRE(from_binary(same, data));
+    CHECK(get<gamma_>(same) == "chain 1");
+    CHECK(get<delta_, beta_>(same) == "inner");
+
+    // reordered, one field retyped and one added (both get their default), nested field removed
+    using inner_v2 = tagged_tuple<no_metadata, field<beta_, std::string>>;
+    using v2_t = tagged_tuple<no_metadata, field<delta_, inner_v2>, field<gamma_, std::string>,
+                              field<beta_, float>, field<t1, std::vector<int>>,
+                              field<alpha_, std::unique_ptr<int>>>;
+    v2_t v2;
+    get<beta_>(v2) = -1;
+    get<t1>(v2) = {1, 2};
+    REQUIRE(from_binary(v2, data));
+    CHECK(get<gamma_>(v2) == "chain 1");
+    CHECK(get<delta_, beta_>(v2) == "inner");
+    CHECK(get<beta_>(v2) == 0);
+    CHECK(get<t1>(v2).empty());
+    CHECK(std::get<4>(v2.data) == nullptr);  // int and unique_ptr<int> are different types
+
+    // encoded (non-raw) tuples round trip pointers and vectors
+    auto p = make_tagged_tuple(unique_ptr_field<alpha_>(4.5),
+                               value_field<beta_>(std::vector<std::string>{"a", "bc"}));
+    decltype(p) q;
+    REQUIRE(from_binary(q, to_binary(p)));
+    CHECK(get<alpha_>(q) == 4.5);
+    CHECK(get<beta_>(q) == std::vector<std::string>{"a", "bc"});
+
+    CHECK(not from_binary(q, data.substr(0, data.size() - 1)));
+    CHECK(not from_binary(q, "garbage"));
+}
+
+TEST_CASE("Binary serialization of untrusted input and wrapped fields") {
+    // lengths larger than the input are rejected before allocating
+    using vector_t = tagged_tuple<no_metadata, field<alpha_, std::vector<std::string>>>;
+    std::string data = to_binary(vector_t());
+    uint64_t huge = uint64_t(1) << 60;
+    std::string forged = data;
+    std::memcpy(&forged[forged.size() - sizeof(huge)], &huge, sizeof(huge));
+    vector_t v;
+    CHECK(not from_binary(v, forged));
+    forged = data;
+    uint32_t nb_fields = 1u << 30;
+    std::memcpy(&forged[9], &nb_fields, sizeof(nb_fields));
+    CHECK(not from_binary(v, forged));
+
+    // raw payloads with bool fields are decoded field by field, and checked
+    using flags_t = tagged_tuple<no_metadata, field<alpha_, bool>, field<beta_, char>>;
+    flags_t f;
+    get<alpha_>(f) = true;
+    get<beta_>(f) = 5;
+    data = to_binary(f);
+    flags_t g;
+    REQUIRE(from_binary(g, data));
+    CHECK(g == f);
+    auto flag_offset = data.size() - sizeof(f.data) +
+                       size_t(reinterpret_cast<const char*>(&get<alpha_>(f)) -
+                              reinterpret_cast<const char*>(&f.data));
+    data[flag_offset] = 2;
+    CHECK(not from_binary(g, data));
+
+    // copied as is, field by field
+    using md = metadata<type_list<standard_layout>, type_map<>>;
+    using plain_t = tagged_tuple<md, field<alpha_, int>, field<beta_, float>>;
+    static_assert(helper::binary_schema<plain_t>::raw_decodable, "");
+    static_assert(helper::binary_schema<flags_t>::raw, "");
+    static_assert(not helper::binary_schema<flags_t>::raw_decodable, "");
+    plain_t p;
+    get<alpha_>(p) = 1;
+    get<beta_>(p) = 2.5;
+    plain_t p2;
+    REQUIRE(from_binary(p2, to_binary(p)));
+    CHECK(get<beta_>(p2) == 2.5);
+
+    // padding bytes are not written: equal tuples have equal encodings
+    using padded_t = tagged_tuple<md, field<alpha_, char>, field<beta_, double>>;
+    static_assert(not helper::binary_schema<padded_t>::raw, "");
+    alignas(padded_t) unsigned char buffer1[sizeof(padded_t)];
+    alignas(padded_t) unsigned char buffer2[sizeof(padded_t)];
+    std::memset(buffer1, 0x00, sizeof(buffer1));
+    std::memset(buffer2, 0xff, sizeof(buffer2));
+    auto padded1 = new (buffer1) padded_t;
+    auto padded2 = new (buffer2) padded_t;
+    for (auto padded : {padded1, padded2}) {
+        get<alpha_>(*padded) = 'a';
+        get<beta_>(*padded) = 1.5;
+    }
+    CHECK(to_binary(*padded1) == to_binary(*padded2));
+
+    // std::vector<bool> is one byte per element
+    using bits_t = tagged_tuple<no_metadata, field<alpha_, std::vector<bool>>>;
+    bits_t bits;
+    get<alpha_>(bits) = {true, false, true};
+    bits_t bits2;
+    REQUIRE(from_binary(bits2, to_binary(bits)));
+    CHECK(get<alpha_>(bits2) == get<alpha_>(bits));
+    data = to_binary(bits);
+    data.back() = 2;
+    CHECK(not from_binary(bits2, data));
+
+    // a reference field absent from the input leaves its referent alone
+    int referent = 5;
+    auto with_ref = make_tagged_tuple(ref_field<alpha_>(referent), value_field<beta_>(1));
+    REQUIRE(from_binary(with_ref, to_binary(make_tagged_tuple(value_field<beta_>(2)))));
+    CHECK(referent == 5);
+    CHECK(get<beta_>(with_ref) == 2);
+
+    // atomic, isolated and pooled fields are encoded as their declared types
+    using wrapped_md =
+        metadata<type_list<>, type_map<property<concurrent, type_list<alpha_>>,
+                                       property<cache_line_isolated, type_list<beta_>>,
+                                       property<pooled, type_list<gamma_>>>>;
+    using wrapped_t = tagged_tuple<wrapped_md, field<alpha_, int>, field<beta_, double>,
+                                   field<gamma_, std::unique_ptr<std::string>>>;
+    using plain_fields_t = tagged_tuple<no_metadata, field<alpha_, int>, field<beta_, double>,
+                                        field<gamma_, std::unique_ptr<std::string>>>;
+    wrapped_t w;
+    store<alpha_>(w, 3);
+    get<beta_>(w) = 4.5;
+    std::get<2>(w.data) = make_pooled<std::string>("pooled");
+    plain_fields_t plain;
+    REQUIRE(from_binary(plain, to_binary(w)));
+    CHECK(get<alpha_>(plain) == 3);
+    CHECK(get<beta_>(plain) == 4.5);
+    CHECK(get<gamma_>(plain) == "pooled");
+    wrapped_t w2;
+    REQUIRE(from_binary(w2, to_binary(plain)));
+    CHECK(load<alpha_>(w2) == 3);
+    CHECK(get<beta_>(w2) == 4.5);
+    CHECK(get<gamma_>(w2) == "pooled");
+    std::get<2>(plain.data).reset();
+    REQUIRE(from_binary(w2, to_binary(plain)));
+    CHECK(std::get<2>(w2.data).get() == nullptr);
+}
+
+TEST_CASE("schema hash") {
+    using inner_t = tagged_tuple<no_metadata, field<alpha_, int>, field<beta_, std::string>>;
+    using tuple_t = tagged_tuple<no_metadata, field<t1, std::vector<double>>, field<t2, inner_t>>;
+    static_assert(schema_hash<tuple_t> != 0, "schema_hash should be a constant expression");
+
+    // same fields: same hash, whatever the metadata
+    using md = metadata<type_list<standard_layout>, type_map<>>;
+    using same_t = tagged_tuple<md, field<t1, std::vector<double>>, field<t2, inner_t>>;
+    CHECK(schema_hash<same_t> == schema_hash<tuple_t>);
+    CHECK(schema_hash_of(tuple_t()) == schema_hash<tuple_t>);
+
+    // renamed, retyped, reordered, nested change
+    using renamed_t = tagged_tuple<no_metadata, field<t1, std::vector<double>>,
+                                   field<gamma_, inner_t>>;
+    using retyped_t = tagged_tuple<no_metadata, field<t1, std::vector<float>>,
+                                   field<t2, inner_t>>;
+    using reordered_t = tagged_tuple<no_metadata, field<t2, inner_t>,
+                                     field<t1, std::vector<double>>>;
+    using inner2_t = tagged_tuple<no_metadata, field<alpha_, long>, field<beta_, std::string>>;
+    using nested_t = tagged_tuple<no_metadata, field<t1, std::vector<double>>,
+                                  field<t2, inner2_t>>;
+    CHECK(schema_hash<renamed_t> != schema_hash<tuple_t>);
+    CHECK(schema_hash<retyped_t> != schema_hash<tuple_t>);
+    CHECK(schema_hash<reordered_t> != schema_hash<tuple_t>);
+    CHECK(schema_hash<nested_t> != schema_hash<tuple_t>);
+
+    // numbers are identified by kind and size, not spelling
+    CHECK(stable_type_hash<int32_t>::value == stable_type_hash<signed int>::value);
+    CHECK(stable_type_hash<uint32_t>::value != stable_type_hash<int32_t>::value);
+    CHECK(stable_type_hash<pooled_ptr<int>>::value ==
+          stable_type_hash<std::unique_ptr<int>>::value);
+    CHECK(stable_type_hash<shared_value<int>>::value ==
+          stable_type_hash<local_shared_value<int>>::value);
+
+    // the value does not depend on the compiler
+    CHECK(schema_hash<tuple_t> == 0x2c8f288bf6510d09ull);
+}
+
+TEST_CASE("Comparison of pointer-like and wrapped fields") {
+    using md = metadata<type_list<>, type_map<property<pooled, type_list<alpha_>>,
+                                              property<cache_line_isolated, type_list<beta_>>,
+                                              property<concurrent, type_list<gamma_>>>>;
+    auto make = [](double a, int b, int c, std::string d, int e) {
+        return make_tagged_tuple<md>(unique_ptr_field<alpha_>(a), value_field<beta_>(b),
+                                     value_field<gamma_>(c), cow_field<delta_>(d),
+                                     shared_field<t1>(e));
+    };
+    CHECK(make(1.5, 2, 3, "x", 4) == make(1.5, 2, 3, "x", 4));
+    CHECK(make(1.5, 2, 3, "x", 4) != make(2.5, 2, 3, "x", 4));
+    CHECK(make(1.5, 2, 3, "x", 4) != make(1.5, 0, 3, "x", 4));
+    CHECK(make(1.5, 2, 3, "x", 4) != make(1.5, 2, 0, "x", 4));
+    CHECK(make(1.5, 2, 3, "x", 4) != make(1.5, 2, 3, "y", 4));
+    CHECK(make(1.5, 2, 3, "x", 4) != make(1.5, 2, 3, "x", 0));
+    CHECK(make(1.5, 2, 3, "x", 4) < make(1.5, 2, 3, "y", 0));
+
+    auto a = make(1.5, 2, 3, "x", 4);
+    auto b = make(1.5, 2, 3, "x", 4);
+    std::get<0>(b.data).reset();  // null pooled pointer is smaller than any value
+    CHECK(a != b);
+    CHECK(b < a);
+    std::get<0>(a.data).reset();
+    CHECK(a == b);
+}
+
+TEST_CASE("Hashing and JSON of pointer-like and wrapped fields") {
+    using md = metadata<type_list<>, type_map<property<pooled, type_list<alpha_>>,
+                                              property<cache_line_isolated, type_list<beta_>>,
+                                              property<concurrent, type_list<gamma_>>>>;
+    auto make = [](double a, int b, int c, std::string d, int e) {
+        return make_tagged_tuple<md>(unique_ptr_field<alpha_>(a), value_field<beta_>(b),
+                                     value_field<gamma_>(c), cow_field<delta_>(d),
+                                     shared_field<t1>(e));
+    };
+    auto t = make(1.5, 2, 3, "x", 4);
+    std::hash<decltype(t)> h;
+    CHECK(h(t) == h(make(1.5, 2, 3, "x", 4)));
+    CHECK(h(t) != h(make(1.5, 2, 3, "y", 4)));
+
+    std::string json = to_json(t);
+    CHECK(json == "{\"alpha_\":1.5,\"beta_\":2,\"gamma_\":3,\"delta_\":\"x\",\"t1\":4}");
+    auto u = make(0, 0, 0, "", 0);
+    std::get<0>(u.data).reset();
+    CHECK(from_json(u, json));
+    CHECK(u == t);
+    CHECK(from_json(u, "{\"alpha_\":null}"));
+    CHECK(std::get<0>(u.data).get() == nullptr);
+    CHECK(to_json(u) == "{\"alpha_\":null,\"beta_\":2,\"gamma_\":3,\"delta_\":\"x\",\"t1\":4}");
+    CHECK(not from_json(u, "{\"beta_\":null}"));
+
+    auto c = make_tagged_tuple(cow_field<delta_>(std::string("x")));
+    auto c_copy = c;
+    CHECK(from_json(c, "{\"delta_\":\"y\"}"));
+    CHECK(get<delta_>(c_copy) == "x");  // the shared value was cloned before being read into
+}
+
+TEST_CASE("Memory report through pointer-like fields") {
+    using md = metadata<type_list<>, type_map<property<pooled, type_list<alpha_>>>>;
+    auto t = make_tagged_tuple<md>(unique_ptr_field<alpha_>(std::vector<int>(100)),
+                                   cow_field<beta_>(std::vector<int>(10)),
+                                   shared_field<gamma_>(std::vector<int>(20)));
+    auto report = memory_report(t);
+    REQUIRE(report.size() == 3);
+    CHECK(report[0].heap_bytes == sizeof(std::vector<int>) + 100 * sizeof(int));
+    CHECK(report[1].heap_bytes > 10 * sizeof(int));
+    CHECK(report[2].heap_bytes > 20 * sizeof(int));
+
+    // nested tuples behind pointers are reported field by field, even if null in some tuples
+    using inner_t = tagged_tuple<no_metadata, field<alpha_, std::vector<int>>>;
+    using outer_t = tagged_tuple<no_metadata, field<alpha_, std::unique_ptr<inner_t>>,
+                                 field<beta_, int>>;
+    std::vector<outer_t> v(3);
+    std::get<0>(v[1].data) = std::make_unique<inner_t>();
+    get<alpha_, alpha_>(v[1]).reserve(5);
+    auto aggregate = memory_report(v);
+    REQUIRE(aggregate.size() == 3);
+    CHECK(aggregate[0].path == "alpha_");
+    CHECK(aggregate[0].heap_bytes == sizeof(inner_t) + 5 * sizeof(int));
+    CHECK(aggregate[1].path == "alpha_.alpha_");
+    CHECK(aggregate[1].count == 1);
+    CHECK(aggregate[1].heap_bytes == 5 * sizeof(int));
+    CHECK(aggregate[2].path == "beta_");
+    CHECK(aggregate[2].count == 3);
+}
+
+TEST_CASE("Tagged variant with throwing constructors") {
+    struct thrower {
+        thrower() = default;
+        thrower(int) { throw 1; }
+        thrower(const thrower&) { throw 2; }
+    };
+    using variant_t = tagged_variant<field<alpha_, std::shared_ptr<int>>, field<beta_, thrower>>;
+    auto p = std::make_shared<int>(3);
+    auto v = make_tagged_variant<variant_t, alpha_>(p);
+    CHECK(p.use_count() == 2);
+
+    CHECK_THROWS(v.emplace<beta_>(0));
+    CHECK(holds<alpha_>(v));  // unchanged
+    CHECK(p.use_count() == 2);
+    v.emplace<alpha_>(get<alpha_>(v));  // argument refers to the current value
+    CHECK(get<alpha_>(v) == p);
+    CHECK(p.use_count() == 2);
+
+    auto w = make_tagged_variant<variant_t, beta_>();
+    CHECK_THROWS(v = w);  // copy made before the old value is destroyed
+    CHECK(get<alpha_>(v) == p);
+    CHECK_THROWS(v = std::move(w));  // thrower has no move constructor: its copy throws
+    CHECK(v.valueless());
+    CHECK(p.use_count() == 1);
+    CHECK_THROWS_AS(visit(v, [](const auto&) {}), bad_tagged_variant_access);
+    v = make_tagged_variant<variant_t, alpha_>(p);
+    CHECK(p.use_count() == 2);
+}
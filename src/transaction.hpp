@@ -0,0 +1,259 @@
+/*Copyright or © or Copr. CNRS (2019). Contributors:
+- Vincent Lanore. vincent.lanore@gmail.com
+
+This software is a computer program whose purpose is to provide header-only library to create tuple
+indexed by type tags.
+
+This software is governed by the CeCILL-C license under French law and abiding by the rules of
+distribution of free software. You can use, modify and/ or redistribute the software under the terms
+of the CeCILL-C license as circulated by CEA, CNRS and INRIA at the following URL
+"http://www.cecill.info".
+
+As a counterpart to the access to the source code and rights to copy, modify and redistribute
+granted by the license, users are provided only with a limited warranty and the software's author,
+the holder of the economic rights, and the successive licensors have only limited liability.
+
+In this respect, the user's attention is drawn to the risks associated with loading, using,
+modifying and/or developing or reproducing the software by the user in light of its specific status
+of free software, that may mean that it is complicated to manipulate, and that also therefore means
+that it is reserved for developers and experienced professionals having in-depth computer knowledge.
+Users are therefore encouraged to load and test the software's suitability as regards their
+requirements in conditions enabling the security of their systems and/or data to be ensured and,
+more generally, to use and operate it in the same conditions as regards security.
+
+The fact that you are presently reading this means that you have had knowledge of the CeCILL-C
+license and that you accept its terms.*/
+
+#pragma once
+
+#include <array>
+#include <new>
+#include "tagged_tuple.hpp"
+
+/* A transaction scope records the old value of a field the first time it is accessed mutably
+through get<Key>(scope), which goes through get<Key> on the tuple. commit() drops the saved values
+and rollback() restores them; both only touch the fields that were accessed, and fields that are
+never accessed are not dereferenced at all (e.g. null pointers or shared copy-on-write values).
+Fields containing tagged tuples are handled by nested scopes, opened on first access, so only the
+inner fields that were actually accessed are saved. A scope that is destroyed with pending changes
+rolls them back. */
+
+template <class TTuple>
+class transaction_scope;
+
+//==================================================================================================
+namespace helper {
+    // saved old value of a field; empty until the field is first touched
+    template <class T>
+    class saved_value {
+        typename std::aligned_storage<sizeof(T), alignof(T)>::type storage;
+        bool engaged{false};
+
+      public:
+        saved_value() = default;
+        saved_value(const saved_value&) = delete;
+        saved_value(saved_value&& other) {
+            if (other.engaged) {
+                save(std::move(other.value()));
+                other.reset();
+            }
+        }
+        ~saved_value() { reset(); }
+
+        template <class U>
+        void save(U&& v) {
+            assert(not engaged);
+            new (&storage) T(std::forward<U>(v));
+            engaged = true;
+        }
+        T& value() {
+            assert(engaged);
+            return *reinterpret_cast<T*>(&storage);
+        }
+        void reset() {
+            if (engaged) {
+                value().~T();
+                engaged = false;
+            }
+        }
+    };
+
+    // fields containing tagged tuples get a nested transaction, others a saved value; both are
+    // empty until the field is first touched
+    template <class T, bool = is_tagged_tuple<T>::value>
+    struct transaction_slot {
+        using type = saved_value<T>;
+    };
+
+    template <class T>
+    struct transaction_slot<T, true> {
+        using type = saved_value<transaction_scope<T>>;
+    };
+
+    // dereferenced type of the field at index I (pointee for pointer fields)
+    template <size_t I, class TTuple>
+    using transaction_value_t =
+        std::decay_t<decltype(deref_if_ptr(get<I>(std::declval<TTuple&>().data)))>;
+
+    template <class TTuple, class Indices>
+    struct transaction_slots;
+
+    template <class TTuple, size_t... Is>
+    struct transaction_slots<TTuple, std::index_sequence<Is...>> {
+        using type =
+            std::tuple<typename transaction_slot<transaction_value_t<Is, TTuple>>::type...>;
+    };
+
+    template <class T>
+    auto& transaction_touch(saved_value<T>& slot, T& field) {
+        static_assert(std::is_copy_constructible<T>::value,
+                      "Field accessed through a transaction must be copy constructible");
+        slot.save(field);
+        return field;
+    }
+
+    template <class T>
+    auto& transaction_touch(saved_value<transaction_scope<T>>& slot, T& field) {
+        slot.save(field);
+        return slot.value();
+    }
+
+    template <class T>
+    auto& transaction_access(saved_value<T>&, T& field) {
+        return field;
+    }
+
+    template <class T>
+    auto& transaction_access(saved_value<transaction_scope<T>>& slot, T&) {
+        return slot.value();
+    }
+
+    // (fields are only dereferenced if they were touched)
+    template <class T, class Field>
+    void transaction_rollback(saved_value<T>& slot, Field& field) {
+        deref_if_ptr(field) = std::move(slot.value());
+        slot.reset();
+    }
+
+    template <class T, class Field>
+    void transaction_rollback(saved_value<transaction_scope<T>>& slot, Field&) {
+        slot.value().rollback();
+        slot.reset();
+    }
+
+    template <class T, class Field>
+    void transaction_commit(saved_value<T>& slot, Field&) {
+        slot.reset();
+    }
+
+    template <class T, class Field>
+    void transaction_commit(saved_value<transaction_scope<T>>& slot, Field&) {
+        slot.value().commit();
+        slot.reset();
+    }
+}  // namespace helper
+
+//==================================================================================================
+template <class TTuple>
+class transaction_scope {
+    static constexpr size_t nb_fields = tuple_nb_fields<TTuple>::value;
+    using indices = std::make_index_sequence<nb_fields>;
+    using slots_t = helper::transaction_slots<TTuple, indices>;
+
+    TTuple& t;
+    typename slots_t::type slots;
+    std::array<bool, nb_fields> touched{};        // per field: has the field been saved?
+    std::array<size_t, nb_fields> touched_list{};  // indices of saved fields, in touch order
+    size_t nb_touched_{0};
+
+    template <size_t I>
+    static void rollback_field(transaction_scope& tx) {
+        helper::transaction_rollback(get<I>(tx.slots), get<I>(tx.t.data));
+    }
+
+    template <size_t I>
+    static void commit_field(transaction_scope& tx) {
+        helper::transaction_commit(get<I>(tx.slots), get<I>(tx.t.data));
+    }
+
+    template <size_t... Is>
+    void apply(bool rollback, std::index_sequence<Is...>) {
+        using fun_t = void (*)(transaction_scope&);
+        static constexpr std::array<fun_t, nb_fields> rollback_table{{&rollback_field<Is>...}};
+        static constexpr std::array<fun_t, nb_fields> commit_table{{&commit_field<Is>...}};
+        // rollback in reverse touch order (matters only for aliasing fields, e.g. refs)
+        for (size_t i = nb_touched_; i > 0; i--) {
+            size_t index = touched_list[i - 1];
+            (rollback ? rollback_table : commit_table)[index](*this);
+            touched[index] = false;
+        }
+        nb_touched_ = 0;
+    }
+
+  public:
+    explicit transaction_scope(TTuple& t) : t(t) {}
+
+    transaction_scope(const transaction_scope&) = delete;
+    transaction_scope(transaction_scope&& other)
+        : t(other.t),
+          slots(std::move(other.slots)),
+          touched(other.touched),
+          touched_list(other.touched_list),
+          nb_touched_(other.nb_touched_) {
+        other.touched = std::array<bool, nb_fields>{};
+        other.nb_touched_ = 0;
+    }
+    transaction_scope& operator=(const transaction_scope&) = delete;
+
+    ~transaction_scope() { rollback(); }
+
+    // saves field I, whose value is field, on first access and returns a mutable reference to it
+    // (or the nested transaction if the field is a tagged tuple)
+    template <size_t I>
+    auto& touch(helper::transaction_value_t<I, TTuple>& field) {
+        if (not touched[I]) {
+            touched[I] = true;
+            touched_list[nb_touched_++] = I;
+            return helper::transaction_touch(get<I>(slots), field);
+        }
+        return helper::transaction_access(get<I>(slots), field);
+    }
+
+    // keeps all changes made since the last commit/rollback
+    void commit() { apply(false, indices()); }
+
+    // restores all fields touched since the last commit/rollback
+    void rollback() { apply(true, indices()); }
+
+    // number of fields of this tuple (not counting nested tuples) saved by the transaction
+    size_t nb_touched() const { return nb_touched_; }
+
+    TTuple& tuple() { return t; }
+    const TTuple& tuple() const { return t; }
+};
+
+template <class TTuple>
+constexpr size_t transaction_scope<TTuple>::nb_fields;
+
+//==================================================================================================
+template <class MD, class... Fields>
+auto transaction(tagged_tuple<MD, Fields...>& t) {
+    return transaction_scope<tagged_tuple<MD, Fields...>>(t);
+}
+
+template <class Key, class TTuple>
+auto& get(transaction_scope<TTuple>& tx) {
+    constexpr size_t index = map_element_index<Key, field_map_t<TTuple>>::value;
+    return tx.template touch<index>(get<Key>(tx.tuple()));
+}
+
+template <class FirstKey, class SecondKey, class... Rest, class TTuple>
+auto& get(transaction_scope<TTuple>& tx) {
+    return get<SecondKey, Rest...>(get<FirstKey>(tx));
+}
+
+// read-only access does not save anything
+template <class Key, class... Keys, class TTuple>
+const auto& get(const transaction_scope<TTuple>& tx) {
+    return get<Key, Keys...>(tx.tuple());
+}
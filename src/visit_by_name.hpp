@@ -0,0 +1,162 @@
+/*Copyright or © or Copr. CNRS (2019). Contributors:
+- Vincent Lanore. vincent.lanore@gmail.com
+
+This software is a computer program whose purpose is to provide header-only library to create tuple
+indexed by type tags.
+
+This software is governed by the CeCILL-C license under French law and abiding by the rules of
+distribution of free software. You can use, modify and/ or redistribute the software under the terms
+of the CeCILL-C license as circulated by CEA, CNRS and INRIA at the following URL
+"http://www.cecill.info".
+
+As a counterpart to the access to the source code and rights to copy, modify and redistribute
+granted by the license, users are provided only with a limited warranty and the software's author,
+the holder of the economic rights, and the successive licensors have only limited liability.
+
+In this respect, the user's attention is drawn to the risks associated with loading, using,
+modifying and/or developing or reproducing the software by the user in light of its specific status
+of free software, that may mean that it is complicated to manipulate, and that also therefore means
+that it is reserved for developers and experienced professionals having in-depth computer knowledge.
+Users are therefore encouraged to load and test the software's suitability as regards their
+requirements in conditions enabling the security of their systems and/or data to be ensured and,
+more generally, to use and operate it in the same conditions as regards security.
+
+The fact that you are presently reading this means that you have had knowledge of the CeCILL-C
+license and that you accept its terms.*/
+
+#pragma once
+
+#include "tag_name.hpp"
+
+/* Runtime access to fields by name. For each tagged tuple type, a perfect hash table mapping field
+names to field indices is built at compile time from the tag names, so that finding a field takes
+one hash and one string comparison. */
+
+//==================================================================================================
+namespace helper {
+    constexpr size_t next_power_of_two(size_t n) {
+        size_t result = 1;
+        while (result < n) { result *= 2; }
+        return result;
+    }
+
+    template <size_t N>
+    struct perfect_hash_table {
+        static constexpr size_t capacity = next_power_of_two(4 * N);
+        bool found{false};  // false if names contain duplicates or no seed was found
+        uint64_t seed{0};
+        int slots[capacity]{};  // slot -> field index, -1 for empty slots
+
+        constexpr size_t slot(uint64_t hash) const {
+            return mix_hash(hash ^ seed) & (capacity - 1);
+        }
+    };
+
+    template <size_t N>
+    constexpr perfect_hash_table<N> make_perfect_hash_table(
+        const std::array<const_string, N>& names) {
+        using table_t = perfect_hash_table<N>;
+        table_t table{};
+        uint64_t hashes[N + 1] = {};
+        for (size_t i = 0; i < N; i++) {
+            hashes[i] = fnv1a(names[i]);
+            for (size_t j = 0; j < i; j++) {
+                if (names[i] == names[j]) { return table; }
+            }
+        }
+        // with a load factor of at most 1/4, a suitable seed is found after a few tries
+        for (uint64_t seed = 0; seed < (1 << 16); seed++) {
+            table.seed = seed * 0x9e3779b97f4a7c15ull;
+            for (size_t s = 0; s < table_t::capacity; s++) { table.slots[s] = -1; }
+            bool collision = false;
+            for (size_t i = 0; i < N and not collision; i++) {
+                size_t s = table.slot(hashes[i]);
+                collision = table.slots[s] != -1;
+                table.slots[s] = static_cast<int>(i);
+            }
+            if (not collision) {
+                table.found = true;
+                return table;
+            }
+        }
+        return table;
+    }
+
+    template <class TTuple>
+    struct name_table {
+        static constexpr size_t size = tuple_nb_fields<TTuple>::value;
+        static constexpr std::array<const_string, size> names = field_names<TTuple>();
+        static constexpr perfect_hash_table<size> table = make_perfect_hash_table(names);
+        static_assert(table.found, "Could not build name table (are there duplicate field names?)");
+
+        static int find(const_string name) {
+            int index = table.slots[table.slot(fnv1a(name))];
+            return (index >= 0 and names[index] == name) ? index : -1;
+        }
+    };
+
+    template <class TTuple>
+    constexpr std::array<const_string, name_table<TTuple>::size> name_table<TTuple>::names;
+
+    template <class TTuple>
+    constexpr perfect_hash_table<name_table<TTuple>::size> name_table<TTuple>::table;
+}  // namespace helper
+
+// index of the field called name in TTuple, -1 if there is no such field
+template <class TTuple>
+int field_index_by_name(const_string name) {
+    return helper::name_table<std::remove_const_t<TTuple>>::find(name);
+}
+
+//==================================================================================================
+template <class TTuple, class F>
+bool visit_by_name(TTuple& t, const_string path, F&& f);
+
+namespace helper {
+    template <class T, class F>
+    bool visit_path(T& value, const_string rest, F& f, std::true_type /* is tagged tuple */) {
+        if (rest.empty()) {
+            f(value);
+            return true;
+        }
+        return visit_by_name(value, rest.substr(1), f);  // rest starts with '.'
+    }
+
+    template <class T, class F>
+    bool visit_path(T& value, const_string rest, F& f, std::false_type /* is tagged tuple */) {
+        if (rest.empty()) {
+            f(value);
+            return true;
+        }
+        return false;
+    }
+
+    template <size_t I, class TTuple, class F>
+    bool visit_field(TTuple& t, const_string rest, F& f) {
+        auto& value = deref_if_ptr(get<I>(t.data));
+        using value_t = std::remove_const_t<std::remove_reference_t<decltype(value)>>;
+        return visit_path(value, rest, f, is_tagged_tuple<value_t>());
+    }
+
+    template <class TTuple, class F, size_t... Is>
+    bool visit_by_index(TTuple& t, int index, const_string rest, F& f,
+                        std::index_sequence<Is...>) {
+        using fun_t = bool (*)(TTuple&, const_string, F&);
+        static constexpr fun_t table[sizeof...(Is) + 1] = {&visit_field<Is, TTuple, F>..., nullptr};
+        return table[index](t, rest, f);
+    }
+}  // namespace helper
+
+/* Calls f on the field designated by path, e.g. "alpha" or "model.branch.length" for nested
+tuples. Returns false (without calling f) if there is no such field. f must accept every field
+type it may be called with (e.g. a generic lambda). */
+template <class TTuple, class F>
+bool visit_by_name(TTuple& t, const_string path, F&& f) {
+    using tuple_t = std::remove_const_t<TTuple>;
+    static_assert(is_tagged_tuple<tuple_t>::value, "visit_by_name expects a tagged tuple");
+    size_t dot = path.find('.');
+    int index = field_index_by_name<tuple_t>(path.substr(0, dot));
+    if (index < 0) { return false; }
+    return helper::visit_by_index(t, index, path.substr(dot), f,
+                                  std::make_index_sequence<tuple_nb_fields<tuple_t>::value>());
+}